@@ -0,0 +1,193 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+    /// @brief Prevents the compiler from optimizing away a value, which is computed only to be measured.
+    template <typename T>
+    inline void DoNotOptimize(T const &value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile void const *sink;
+        sink = &value;
+#endif
+    }
+
+    /// @brief Writes generated config content into a file in the temporary directory
+    /// @param name file name
+    /// @param content config content
+    /// @return absolute path to the written file
+    inline std::filesystem::path WriteTemp(std::string const &name, std::string const &content)
+    {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << content;
+        return std::filesystem::absolute(path);
+    }
+
+    /// @brief Command line options of the benchmark suite
+    struct Options
+    {
+        std::string filter;                     // Runs only cases whose name contains the filter
+        std::string json = "libcfg_bench.json"; // File, which the results are written to as JSON
+        uint64_t max_size = uint64_t(16) << 20; // Largest generated config for load benchmarks in bytes
+    };
+
+    /// @brief Global options, which are set from the command line before running the cases
+    inline Options &GlobalOptions()
+    {
+        static Options options;
+        return options;
+    }
+
+    /// @brief Measurement of a single benchmark case
+    struct Result
+    {
+        std::string name;   // Case name, including the parameters it is measured with
+        uint64_t iters;     // Number of measured iterations
+        double ns_per_op;   // Average wall-clock time per iteration in nanoseconds
+        uint64_t bytes = 0; // Memory footprint in bytes, zero unless the case measures one
+    };
+
+    /// @brief Collects and prints measurements of benchmark cases
+    class Reporter
+    {
+        std::vector<Result> _results; // Measurements in the order of execution
+
+        /// @brief Escapes a string for a JSON string literal
+        static std::string escape(std::string const &str)
+        {
+            std::string escaped;
+            for (char ch : str)
+            {
+                if (ch == '"' || ch == '\\')
+                {
+                    escaped.push_back('\\');
+                }
+                escaped.push_back(ch);
+            }
+            return escaped;
+        }
+
+    public:
+        /// @brief Runs the given operation repeatedly, until a minimum measurement time has elapsed, and records
+        /// the average time per iteration.
+        /// @param name case name
+        /// @param op operation to measure
+        template <typename Op>
+        void Measure(std::string const &name, Op &&op)
+        {
+            using clock = std::chrono::steady_clock;
+            const auto min_time = std::chrono::milliseconds(200);
+            uint64_t iters = 1;
+            while (true)
+            {
+                const auto start = clock::now();
+                for (uint64_t idx = 0; idx < iters; idx++)
+                {
+                    op();
+                }
+                const auto elapsed = clock::now() - start;
+                if (elapsed >= min_time || iters >= (uint64_t(1) << 40))
+                {
+                    const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+                    Record(Result{name, iters, ns / double(iters)});
+                    return;
+                }
+                iters *= 2;
+            }
+        }
+
+        /// @brief Records an externally measured result
+        void Record(Result const &result)
+        {
+            std::cout << result.name << ": " << result.ns_per_op << " ns/op (" << result.iters << " iterations)\n";
+            _results.push_back(result);
+        }
+
+        /// @brief Records a memory footprint, which is compared between releases like the measured times
+        /// @param name case name
+        /// @param bytes memory footprint in bytes
+        void RecordBytes(std::string const &name, uint64_t bytes)
+        {
+            std::cout << name << ": " << bytes << " bytes\n";
+            _results.push_back(Result{name, 0, 0., bytes});
+        }
+
+        /// @brief Measurements recorded so far
+        std::vector<Result> const &Results() const
+        {
+            return _results;
+        }
+
+        /// @brief Writes the measurements recorded so far as JSON, which can be compared between releases
+        /// @param path output file
+        /// @return true if the file is written
+        bool WriteJson(std::filesystem::path const &path) const
+        {
+            std::ofstream out(path, std::ios::trunc);
+            const auto now = std::chrono::system_clock::now().time_since_epoch();
+            out << "{\n  \"context\": {\n";
+            out << "    \"library\": \"libcfg\",\n";
+#if defined(__OPTIMIZE__) || defined(NDEBUG)
+            out << "    \"optimized\": true,\n";
+#else
+            out << "    \"optimized\": false,\n";
+#endif
+            out << "    \"timestamp\": " << std::chrono::duration_cast<std::chrono::seconds>(now).count() << "\n";
+            out << "  },\n  \"benchmarks\": [";
+            for (size_t idx = 0; idx < _results.size(); idx++)
+            {
+                Result const &result = _results[idx];
+                out << (idx == 0 ? "\n" : ",\n");
+                out << "    {\"name\": \"" << escape(result.name) << "\", \"iterations\": " << result.iters
+                    << ", \"ns_per_op\": " << result.ns_per_op;
+                if (result.bytes != 0)
+                {
+                    out << ", \"bytes\": " << result.bytes;
+                }
+                out << "}";
+            }
+            out << "\n  ]\n}\n";
+            return out.good();
+        }
+    };
+
+    /// @brief Benchmark case, which records one or more measurements using the reporter
+    using Case = std::function<void(Reporter &)>;
+
+    /// @brief Global registry of benchmark cases
+    inline std::vector<std::pair<std::string, Case>> &Registry()
+    {
+        static std::vector<std::pair<std::string, Case>> registry;
+        return registry;
+    }
+
+    /// @brief Registers a benchmark case at static initialization time
+    struct Registrar
+    {
+        Registrar(std::string const &name, Case const &bench_case)
+        {
+            Registry().emplace_back(name, bench_case);
+        }
+    };
+} // namespace bench
+
+/// @brief Defines and registers a benchmark case
+#define BENCH_CASE(name)                                                 \
+    static void name(bench::Reporter &);                                 \
+    static const bench::Registrar name##_registrar(#name, name);         \
+    static void name(bench::Reporter &reporter)
+
+#endif // BENCH_HPP
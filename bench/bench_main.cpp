@@ -0,0 +1,41 @@
+#include <cstring>
+#include <string>
+
+#include "bench.hpp"
+
+/// Runs all registered benchmark cases and writes the results as JSON.
+/// Usage: libcfg_bench [--json <file>] [--max-size <bytes>] [filter]
+int main(int argc, char **argv)
+{
+    bench::Options &options = bench::GlobalOptions();
+    for (int idx = 1; idx < argc; idx++)
+    {
+        if (std::strcmp(argv[idx], "--json") == 0 && idx + 1 < argc)
+        {
+            options.json = argv[++idx];
+        }
+        else if (std::strcmp(argv[idx], "--max-size") == 0 && idx + 1 < argc)
+        {
+            options.max_size = std::stoull(argv[++idx]);
+        }
+        else
+        {
+            options.filter = argv[idx];
+        }
+    }
+    bench::Reporter reporter;
+    for (auto const &[name, bench_case] : bench::Registry())
+    {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+        {
+            continue;
+        }
+        bench_case(reporter);
+    }
+    if (!reporter.WriteJson(options.json))
+    {
+        std::cerr << "Failed to write results to " << options.json << '\n';
+        return 1;
+    }
+    return 0;
+}
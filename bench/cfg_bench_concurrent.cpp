@@ -0,0 +1,104 @@
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "cfg.hpp"
+
+namespace
+{
+    constexpr size_t SECTIONS = 16; // Number of root-level sections in the generated config
+    constexpr size_t KEYS = 16;     // Number of keys per section
+
+    /// @brief Generates a config with a few sections of scalar values
+    std::string GenerateSections()
+    {
+        std::ostringstream out;
+        for (size_t section = 0; section < SECTIONS; section++)
+        {
+            out << "section" << section << ":\n";
+            for (size_t key = 0; key < KEYS; key++)
+            {
+                out << "  key" << key << ": " << key << ".5\n";
+            }
+        }
+        return out.str();
+    }
+
+    /// @brief Runs the lookup concurrently on the given number of threads and records the aggregate time per
+    /// lookup, i.e. the wall-clock time divided by the total number of lookups of all threads. Linear scaling
+    /// shows up as the aggregate time halving whenever the number of threads doubles.
+    template <typename Lookup>
+    void MeasureThreads(bench::Reporter &reporter, std::string const &name, size_t threads, Lookup &&lookup)
+    {
+        constexpr uint64_t OPS = 20000; // Lookups per thread
+        std::atomic<size_t> ready{0};
+        std::atomic<bool> go{false};
+        std::vector<std::thread> workers;
+        for (size_t idx = 0; idx < threads; idx++)
+        {
+            workers.emplace_back([&, idx]()
+                                 {
+                ready.fetch_add(1);
+                while (!go.load())
+                {
+                    std::this_thread::yield();
+                }
+                for (uint64_t op = 0; op < OPS; op++)
+                {
+                    lookup(idx + op);
+                } });
+        }
+        while (ready.load() != threads)
+        {
+            std::this_thread::yield();
+        }
+        const auto start = std::chrono::steady_clock::now();
+        go.store(true);
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        reporter.Record(bench::Result{name + "/threads:" + std::to_string(threads), OPS * threads,
+                                      ns / double(OPS * threads)});
+    }
+} // namespace
+
+BENCH_CASE(concurrent_get)
+{
+    const auto path = bench::WriteTemp("libcfg_bench_concurrent.yaml", GenerateSections());
+    cfg::LoadOptions options;
+    options.flat_index = true;
+    const cfg::ConfigBase tree = cfg::GetConfig_From(path).value();
+    const cfg::ConfigBase index = cfg::GetConfig_From(path, options).value();
+    std::vector<std::string> hits;
+    std::vector<std::string> misses;
+    std::vector<cfg::Key> handles;
+    for (size_t section = 0; section < SECTIONS; section++)
+    {
+        for (size_t key = 0; key < KEYS; key++)
+        {
+            const std::string prefix = "section" + std::to_string(section) + ".";
+            hits.push_back(prefix + "key" + std::to_string(key));
+            misses.push_back(prefix + "missing" + std::to_string(key));
+            handles.push_back(tree.Compile(hits.back()));
+        }
+    }
+    for (size_t threads = 1; threads <= 64; threads *= 2)
+    {
+        MeasureThreads(reporter, "concurrent_get/tree/hit", threads, [&](size_t idx)
+                       { bench::DoNotOptimize(tree.Get<double>(hits[idx % hits.size()])); });
+        MeasureThreads(reporter, "concurrent_get/tree/miss", threads, [&](size_t idx)
+                       { bench::DoNotOptimize(tree.Get<double>(misses[idx % misses.size()])); });
+        MeasureThreads(reporter, "concurrent_get/index/hit", threads, [&](size_t idx)
+                       { bench::DoNotOptimize(index.Get<double>(hits[idx % hits.size()])); });
+        MeasureThreads(reporter, "concurrent_get/index/miss", threads, [&](size_t idx)
+                       { bench::DoNotOptimize(index.Get<double>(misses[idx % misses.size()])); });
+        MeasureThreads(reporter, "concurrent_get/handle/hit", threads, [&](size_t idx)
+                       { bench::DoNotOptimize(tree.Get<double>(handles[idx % handles.size()])); });
+    }
+}
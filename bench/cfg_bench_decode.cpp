@@ -0,0 +1,169 @@
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "cfg.hpp"
+#include "image.hpp"
+#include "types.hpp"
+
+namespace
+{
+    /// @brief Values read every frame, bound to FRAME_CONFIG
+    struct Frame
+    {
+        cfg::Vec3D dims;
+        cfg::Vec3I color;
+        double saturation;
+    };
+
+    CFG_SCHEMA(Frame,
+               CFG_FIELD(dims, "road.dims"),
+               CFG_FIELD(color, "road.color"),
+               CFG_FIELD(saturation, "road.saturation"));
+
+    /// @brief Config with the kind of values read every frame by render and simulation loops
+    const std::string FRAME_CONFIG = "road:\n"
+                                     "  dims: [50.0, 12.0, 5.1]\n"
+                                     "  color: [255, 128, 64]\n"
+                                     "  saturation: 0.2\n";
+
+    /// @brief Config holding sequences of different lengths and element types
+    const std::string SEQUENCE_CONFIG = "doubles:\n"
+                                        "  len2: [1.5, 2.5]\n"
+                                        "  len3: [1.5, 2.5, 3.5]\n"
+                                        "  len8: [1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5, 8.5]\n"
+                                        "  len16: [1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5, 8.5, "
+                                        "1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5, 8.5]\n"
+                                        "ints:\n"
+                                        "  len3: [255, 128, 64]\n"
+                                        "  len16: [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16]\n"
+                                        "strings:\n"
+                                        "  len3: [\"tom\", \"dick\", \"harry\"]\n";
+
+    /// @brief Measures decoding of a sequence into the given vector type
+    template <typename VecT>
+    void MeasureDecode(bench::Reporter &reporter, cfg::ConfigBase const &base, std::string const &name,
+                       std::string const &key)
+    {
+        const cfg::Key handle = base.Compile(key);
+        reporter.Measure("vec_decode/" + name, [&]()
+                         { bench::DoNotOptimize(base.Get<VecT>(handle)); });
+    }
+} // namespace
+
+BENCH_CASE(vec_decode)
+{
+    const auto path = bench::WriteTemp("libcfg_bench_vec.yaml", SEQUENCE_CONFIG);
+    const cfg::ConfigBase base = cfg::GetConfig_From(path).value();
+    MeasureDecode<cfg::VecD<2>>(reporter, base, "VecD/len:2", "doubles.len2");
+    MeasureDecode<cfg::VecD<3>>(reporter, base, "VecD/len:3", "doubles.len3");
+    MeasureDecode<cfg::VecD<8>>(reporter, base, "VecD/len:8", "doubles.len8");
+    MeasureDecode<cfg::VecD<16>>(reporter, base, "VecD/len:16", "doubles.len16");
+    MeasureDecode<cfg::VecI<3>>(reporter, base, "VecI/len:3", "ints.len3");
+    MeasureDecode<cfg::VecI<16>>(reporter, base, "VecI/len:16", "ints.len16");
+    MeasureDecode<cfg::VecStr<3>>(reporter, base, "VecStr/len:3", "strings.len3");
+}
+
+BENCH_CASE(array_decode)
+{
+    for (size_t len : {size_t(1000), size_t(100000), size_t(1000000)})
+    {
+        if (len * 12 > bench::GlobalOptions().max_size)
+        {
+            break;
+        }
+        std::ostringstream config;
+        config << "table: [";
+        for (size_t idx = 0; idx < len; idx++)
+        {
+            config << (idx > 0 ? ", " : "") << idx * 0.001 - 7.25;
+        }
+        config << "]\n";
+        const auto path = bench::WriteTemp("libcfg_bench_array.yaml", config.str());
+        const std::filesystem::path image_path = path.string() + ".cfgc";
+        cfg::CompileConfig(path, image_path);
+        const cfg::ConfigBase base = cfg::GetConfig_From(path).value();
+        const cfg::ConfigBase image = cfg::GetConfig_From(image_path).value();
+        const YAML::Node root = YAML::LoadFile(path.string());
+        const YAML::Node table = root["table"];
+        const std::string params = "/len:" + std::to_string(len);
+        reporter.Measure("array_decode/yaml_cpp" + params, [&]()
+                         { bench::DoNotOptimize(table.as<std::vector<double>>()); });
+        reporter.Measure("array_decode/tree" + params, [&]()
+                         { bench::DoNotOptimize(base.GetArray<double>("table")); });
+        reporter.Measure("array_decode/image" + params, [&]()
+                         { bench::DoNotOptimize(image.GetArray<double>("table")); });
+        std::filesystem::remove(path);
+        std::filesystem::remove(image_path);
+    }
+}
+
+BENCH_CASE(cached_get)
+{
+    const auto path = bench::WriteTemp("libcfg_bench_decode.yaml", FRAME_CONFIG);
+    const cfg::ConfigBase base = cfg::GetConfig_From(path).value();
+    const cfg::Key ROAD_DIMS = base.Compile("road.dims");
+    const cfg::Key ROAD_COLOR = base.Compile("road.color");
+    const cfg::Key ROAD_SATURATION = base.Compile("road.saturation");
+    reporter.Measure("cached_get/get/double", [&]()
+                     { bench::DoNotOptimize(base.Get<double>(ROAD_SATURATION)); });
+    reporter.Measure("cached_get/cached/double", [&]()
+                     { bench::DoNotOptimize(base.Cached<double>(ROAD_SATURATION)); });
+    reporter.Measure("cached_get/get/Vec3D", [&]()
+                     { bench::DoNotOptimize(base.Get<cfg::Vec3D>(ROAD_DIMS)); });
+    reporter.Measure("cached_get/cached/Vec3D", [&]()
+                     { bench::DoNotOptimize(base.Cached<cfg::Vec3D>(ROAD_DIMS)); });
+    reporter.Measure("cached_get/get/Vec3I", [&]()
+                     { bench::DoNotOptimize(base.Get<cfg::Vec3I>(ROAD_COLOR)); });
+    reporter.Measure("cached_get/cached/Vec3I", [&]()
+                     { bench::DoNotOptimize(base.Cached<cfg::Vec3I>(ROAD_COLOR)); });
+}
+
+BENCH_CASE(schema_bind)
+{
+    const auto path = bench::WriteTemp("libcfg_bench_decode.yaml", FRAME_CONFIG);
+    const cfg::ConfigBase base = cfg::GetConfig_From(path).value();
+    reporter.Measure("schema_bind/get", [&]()
+                     {
+                         Frame frame;
+                         frame.dims = base.Get<cfg::Vec3D>("road.dims").value();
+                         frame.color = base.Get<cfg::Vec3I>("road.color").value();
+                         frame.saturation = base.Get<double>("road.saturation").value();
+                         bench::DoNotOptimize(frame); });
+    reporter.Measure("schema_bind/bind", [&]()
+                     {
+                         Frame frame;
+                         bench::DoNotOptimize(base.Bind(frame));
+                         bench::DoNotOptimize(frame); });
+}
+
+BENCH_CASE(try_get)
+{
+    const auto path = bench::WriteTemp("libcfg_bench_decode.yaml", FRAME_CONFIG);
+    const cfg::ConfigBase base = cfg::GetConfig_From(path).value();
+    const YAML::Node root = YAML::LoadFile(path.string());
+    const cfg::Key ROAD_DIMS = base.Compile("road.dims");
+    // Probing a sequence as a scalar fails, which yaml-cpp signals by throwing YAML::BadConversion
+    reporter.Measure("try_get/yaml_cpp/mismatch", [&]()
+                     {
+                         try
+                         {
+                             bench::DoNotOptimize(root["road"]["dims"].as<double>());
+                         }
+                         catch (YAML::BadConversion const &)
+                         {
+                         } });
+    cfg::SetDiagnostics(nullptr);
+    reporter.Measure("try_get/get/mismatch", [&]()
+                     { bench::DoNotOptimize(base.Get<double>(ROAD_DIMS)); });
+    cfg::SetDiagnostics([](std::string_view message)
+                        { std::cerr << message << '\n'; });
+    reporter.Measure("try_get/try_get/mismatch", [&]()
+                     { bench::DoNotOptimize(base.TryGet<double>(ROAD_DIMS)); });
+    reporter.Measure("try_get/try_get/hit", [&]()
+                     { bench::DoNotOptimize(base.TryGet<cfg::Vec3D>(ROAD_DIMS)); });
+}
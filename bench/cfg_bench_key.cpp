@@ -0,0 +1,121 @@
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "cfg.hpp"
+#include "generate.hpp"
+
+BENCH_CASE(key_lookup)
+{
+    constexpr size_t MAX_DEPTH = 8;
+    const auto path = bench::WriteTemp("libcfg_bench_key.yaml", bench::GenerateNested(MAX_DEPTH, 8));
+    const cfg::ConfigBase base = cfg::GetConfig_From(path).value();
+    for (size_t depth = 1; depth <= MAX_DEPTH; depth++)
+    {
+        const std::string hit = bench::NestedKey(depth);
+        const std::string miss = bench::NestedKey(depth, "missing");
+        const cfg::Key hit_handle = base.Compile(hit);
+        const cfg::Key miss_handle = base.Compile(miss);
+        const std::string params = "/depth:" + std::to_string(depth);
+        reporter.Measure("key_lookup/string/hit" + params, [&]()
+                         { bench::DoNotOptimize(base.Get<double>(hit)); });
+        reporter.Measure("key_lookup/string/miss" + params, [&]()
+                         { bench::DoNotOptimize(base.Get<double>(miss)); });
+        reporter.Measure("key_lookup/handle/hit" + params, [&]()
+                         { bench::DoNotOptimize(base.Get<double>(hit_handle)); });
+        reporter.Measure("key_lookup/handle/miss" + params, [&]()
+                         { bench::DoNotOptimize(base.Get<double>(miss_handle)); });
+    }
+}
+
+BENCH_CASE(width_lookup)
+{
+    cfg::LoadOptions options;
+    options.flat_index = true;
+    for (size_t width : {10, 100, 1000, 10000})
+    {
+        const auto path = bench::WriteTemp("libcfg_bench_wide.yaml", bench::GenerateWide(width));
+        const cfg::ConfigBase tree = cfg::GetConfig_From(path).value();
+        const cfg::ConfigBase index = cfg::GetConfig_From(path, options).value();
+        // The last key of the section is the worst case for a linear scan of the map
+        const std::string hit = "section.key" + std::to_string(width - 1);
+        const std::string miss = "section.missing";
+        const std::string params = "/width:" + std::to_string(width);
+        reporter.Measure("width_lookup/tree/hit" + params, [&]()
+                         { bench::DoNotOptimize(tree.Get<double>(hit)); });
+        reporter.Measure("width_lookup/tree/miss" + params, [&]()
+                         { bench::DoNotOptimize(tree.Get<double>(miss)); });
+        reporter.Measure("width_lookup/index/hit" + params, [&]()
+                         { bench::DoNotOptimize(index.Get<double>(hit)); });
+        reporter.Measure("width_lookup/index/miss" + params, [&]()
+                         { bench::DoNotOptimize(index.Get<double>(miss)); });
+    }
+}
+
+BENCH_CASE(batch_get)
+{
+    constexpr size_t KEYS = 32;
+    for (size_t width : {100, 1000})
+    {
+        const auto path = bench::WriteTemp("libcfg_bench_wide.yaml", bench::GenerateWide(width));
+        const cfg::ConfigBase base = cfg::GetConfig_From(path).value();
+        // Keys are spread evenly across the section, so that one by one lookups scan most of the map each
+        std::vector<std::string> keys;
+        cfg::Batch batch;
+        for (size_t idx = 0; idx < KEYS; idx++)
+        {
+            keys.push_back("section.key" + std::to_string(idx * width / KEYS));
+            batch.Add<double>(keys.back());
+        }
+        const std::string params = "/keys:" + std::to_string(KEYS) + "/width:" + std::to_string(width);
+        reporter.Measure("batch_get/single" + params, [&]()
+                         {
+                             for (std::string const &key : keys)
+                             {
+                                 bench::DoNotOptimize(base.Get<double>(key));
+                             } });
+        reporter.Measure("batch_get/batch" + params, [&]()
+                         { bench::DoNotOptimize(base.Get(batch)); });
+    }
+}
+
+BENCH_CASE(enumerate)
+{
+    for (size_t width : {100, 1000, 10000})
+    {
+        const auto path = bench::WriteTemp("libcfg_bench_wide.yaml", bench::GenerateWide(width));
+        const std::filesystem::path image_path = path.string() + ".cfgc";
+        cfg::CompileConfig(path, image_path);
+        const cfg::ConfigBase tree = cfg::GetConfig_From(path).value();
+        const cfg::ConfigBase image = cfg::GetConfig_From(image_path).value();
+        std::vector<std::string> keys;
+        for (size_t idx = 0; idx < width; idx++)
+        {
+            keys.push_back("section.key" + std::to_string(idx));
+        }
+        const std::string params = "/width:" + std::to_string(width);
+        for (auto const &backend : {std::make_pair("tree", &tree), std::make_pair("image", &image)})
+        {
+            cfg::ConfigBase const &base = *backend.second;
+            // Reading every value of a section by its hard-coded key, compared to visiting the section
+            reporter.Measure(std::string("enumerate/") + backend.first + "/get_each" + params, [&]()
+                             {
+                double sum = 0.;
+                for (std::string const &key : keys)
+                {
+                    sum += base.Get<double>(key).value_or(0.);
+                }
+                bench::DoNotOptimize(sum); });
+            reporter.Measure(std::string("enumerate/") + backend.first + "/for_each" + params, [&]()
+                             {
+                double sum = 0.;
+                base.ForEach("section", [&sum](std::string_view, cfg::ConfigValue const &value)
+                             { sum += value.Get<double>().value_or(0.); });
+                bench::DoNotOptimize(sum); });
+            reporter.Measure(std::string("enumerate/") + backend.first + "/keys" + params, [&]()
+                             { bench::DoNotOptimize(base.Keys("section")); });
+        }
+        std::filesystem::remove(image_path);
+    }
+}
@@ -0,0 +1,282 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "cfg.hpp"
+#include "generate.hpp"
+#include "image.hpp"
+#include "published.hpp"
+#include "writable.hpp"
+
+BENCH_CASE(load)
+{
+    const uint64_t max_size = bench::GlobalOptions().max_size;
+    cfg::LoadOptions index_options;
+    index_options.flat_index = true;
+    cfg::LoadOptions lazy_options;
+    lazy_options.lazy = true;
+    cfg::LoadOptions native_options;
+    native_options.native = true;
+    cfg::LoadOptions compact_options;
+    compact_options.compact = true;
+    for (uint64_t size : {uint64_t(1) << 10, uint64_t(64) << 10, uint64_t(1) << 20, uint64_t(16) << 20,
+                          uint64_t(128) << 20, uint64_t(500) << 20})
+    {
+        if (size > max_size)
+        {
+            break;
+        }
+        const auto path = bench::WriteSized("libcfg_bench_load.yaml", size);
+        const std::string params = "/size:" + bench::SizeName(size);
+        reporter.Measure("load/tree" + params, [&]()
+                         { bench::DoNotOptimize(cfg::GetConfig_From(path)); });
+        reporter.Measure("load/index" + params, [&]()
+                         { bench::DoNotOptimize(cfg::GetConfig_From(path, index_options)); });
+        reporter.Measure("load/lazy" + params, [&]()
+                         {
+            // A lazily parsed config is measured along with reading a single section
+            const boost::optional<cfg::ConfigBase> base = cfg::GetConfig_From(path, lazy_options);
+            bench::DoNotOptimize(base->Get<double>("section0.weight")); });
+        reporter.Measure("load/native" + params, [&]()
+                         { bench::DoNotOptimize(cfg::GetConfig_From(path, native_options)); });
+        reporter.Measure("load/compact" + params, [&]()
+                         { bench::DoNotOptimize(cfg::GetConfig_From(path, compact_options)); });
+        const std::filesystem::path image_path = path.string() + ".cfgc";
+        if (cfg::CompileConfig(path, image_path))
+        {
+            reporter.Measure("load/image" + params, [&]()
+                             { bench::DoNotOptimize(cfg::GetConfig_From(image_path)); });
+            std::filesystem::remove(image_path);
+        }
+        std::filesystem::remove(path);
+    }
+}
+
+BENCH_CASE(memory)
+{
+    cfg::LoadOptions index_options;
+    index_options.flat_index = true;
+    cfg::LoadOptions compact_options;
+    compact_options.compact = true;
+    for (uint64_t size : {uint64_t(64) << 10, uint64_t(1) << 20, uint64_t(16) << 20})
+    {
+        if (size > bench::GlobalOptions().max_size)
+        {
+            break;
+        }
+        const auto path = bench::WriteSized("libcfg_bench_memory.yaml", size);
+        const std::string params = "/size:" + bench::SizeName(size);
+        reporter.RecordBytes("memory/tree" + params, cfg::GetConfig_From(path)->MemoryUsage().Total());
+        reporter.RecordBytes("memory/index" + params, cfg::GetConfig_From(path, index_options)->MemoryUsage().Total());
+        const cfg::ConfigBase compact = cfg::GetConfig_From(path, compact_options).value();
+        reporter.RecordBytes("memory/compact" + params, compact.MemoryUsage().Total());
+        reporter.Measure("memory/compact_get_string" + params, [&]()
+                         { bench::DoNotOptimize(compact.Get<std::string>("section0.name")); });
+        reporter.Measure("memory/compact_get_string_view" + params, [&]()
+                         { bench::DoNotOptimize(compact.Get<std::string_view>("section0.name")); });
+        std::filesystem::remove(path);
+    }
+}
+
+BENCH_CASE(shared_load)
+{
+    for (uint64_t size : {uint64_t(1) << 10, uint64_t(1) << 20, uint64_t(16) << 20})
+    {
+        if (size > bench::GlobalOptions().max_size)
+        {
+            break;
+        }
+        const auto path = bench::WriteSized("libcfg_bench_shared.yaml", size);
+        const std::string params = "/size:" + bench::SizeName(size);
+        reporter.Measure("shared_load/parsed" + params, [&]()
+                         { bench::DoNotOptimize(cfg::GetConfig_From(path)); });
+        cfg::SetSharedConfigCapacity(cfg::GetConfig_From(path).value().MemoryUsage().Total());
+        // Only loads after the first one are served by the registry
+        bench::DoNotOptimize(cfg::GetConfig_From(path));
+        reporter.Measure("shared_load/shared" + params, [&]()
+                         { bench::DoNotOptimize(cfg::GetConfig_From(path)); });
+        cfg::SetSharedConfigCapacity(0);
+        std::filesystem::remove(path);
+    }
+}
+
+BENCH_CASE(published_attach)
+{
+    for (uint64_t size : {uint64_t(1) << 10, uint64_t(1) << 20, uint64_t(16) << 20})
+    {
+        if (size > bench::GlobalOptions().max_size)
+        {
+            break;
+        }
+        const auto path = bench::WriteSized("libcfg_bench_published.yaml", size);
+        const std::string name = "libcfg_bench_published";
+        const std::string params = "/size:" + bench::SizeName(size);
+        reporter.Measure("published_attach/parsed" + params, [&]()
+                         { bench::DoNotOptimize(cfg::GetConfig_From(path)); });
+        reporter.Measure("published_attach/publish" + params, [&]()
+                         { bench::DoNotOptimize(cfg::PublishConfig(path, name)); });
+        // Attaching is measured along with reading a single value, which maps in the pages it touches
+        reporter.Measure("published_attach/attach" + params, [&]()
+                         {
+            const std::unique_ptr<cfg::PublishedConfig> published = cfg::GetPublishedConfig_From(name);
+            bench::DoNotOptimize(published->Get<double>("section0.weight")); });
+        const std::unique_ptr<cfg::PublishedConfig> published = cfg::GetPublishedConfig_From(name);
+        reporter.Measure("published_attach/refresh" + params, [&]()
+                         { bench::DoNotOptimize(published->Refresh()); });
+        cfg::UnpublishConfig(name);
+        std::filesystem::remove(path);
+    }
+}
+
+BENCH_CASE(copy)
+{
+    for (uint64_t size : {uint64_t(1) << 10, uint64_t(1) << 20, uint64_t(16) << 20})
+    {
+        if (size > bench::GlobalOptions().max_size)
+        {
+            break;
+        }
+        const auto path = bench::WriteSized("libcfg_bench_copy.yaml", size);
+        const cfg::ConfigBase base = cfg::GetConfig_From(path).value();
+        reporter.Measure("copy/size:" + bench::SizeName(size), [&]()
+                         {
+            const cfg::ConfigBase copy = base;
+            bench::DoNotOptimize(copy); });
+        std::filesystem::remove(path);
+    }
+}
+
+BENCH_CASE(layered_load)
+{
+    constexpr size_t LAYERS = 8;
+    for (uint64_t size : {uint64_t(64) << 10, uint64_t(1) << 20})
+    {
+        if (size > bench::GlobalOptions().max_size)
+        {
+            break;
+        }
+        std::vector<std::filesystem::path> paths;
+        for (size_t layer = 0; layer < LAYERS; layer++)
+        {
+            paths.push_back(bench::WriteSized("libcfg_bench_layer" + std::to_string(layer) + ".yaml", size));
+        }
+        const std::string params = "/layers:" + std::to_string(LAYERS) + "/size:" + bench::SizeName(size);
+        reporter.Measure("layered_load/largest" + params, [&]()
+                         { bench::DoNotOptimize(cfg::GetConfig_From(paths.front())); });
+        reporter.Measure("layered_load/sequential" + params, [&]()
+                         {
+                             for (std::filesystem::path const &path : paths)
+                             {
+                                 bench::DoNotOptimize(cfg::GetConfig_From(path));
+                             } });
+        reporter.Measure("layered_load/layered" + params, [&]()
+                         { bench::DoNotOptimize(cfg::GetLayeredConfig_From(paths)); });
+        for (std::filesystem::path const &path : paths)
+        {
+            std::filesystem::remove(path);
+        }
+    }
+}
+
+BENCH_CASE(async_load)
+{
+    constexpr size_t FILES = 8;
+    for (uint64_t size : {uint64_t(64) << 10, uint64_t(1) << 20})
+    {
+        if (size > bench::GlobalOptions().max_size)
+        {
+            break;
+        }
+        std::vector<std::filesystem::path> paths;
+        for (size_t file = 0; file < FILES; file++)
+        {
+            paths.push_back(bench::WriteSized("libcfg_bench_async" + std::to_string(file) + ".yaml", size));
+        }
+        const std::string params = "/files:" + std::to_string(FILES) + "/size:" + bench::SizeName(size);
+        reporter.Measure("async_load/sequential" + params, [&]()
+                         {
+                             for (std::filesystem::path const &path : paths)
+                             {
+                                 bench::DoNotOptimize(cfg::GetConfig_From(path));
+                             } });
+        reporter.Measure("async_load/futures" + params, [&]()
+                         {
+                             std::vector<std::future<boost::optional<cfg::ConfigBase>>> futures;
+                             for (std::filesystem::path const &path : paths)
+                             {
+                                 futures.push_back(cfg::GetConfig_FromAsync(path));
+                             }
+                             for (auto &future : futures)
+                             {
+                                 bench::DoNotOptimize(future.get());
+                             } });
+        reporter.Measure("async_load/at_once" + params, [&]()
+                         { bench::DoNotOptimize(cfg::GetConfigs_From(paths)); });
+        for (std::filesystem::path const &path : paths)
+        {
+            std::filesystem::remove(path);
+        }
+    }
+}
+
+BENCH_CASE(config_diff)
+{
+    for (uint64_t size : {uint64_t(64) << 10, uint64_t(1) << 20})
+    {
+        if (size > bench::GlobalOptions().max_size)
+        {
+            break;
+        }
+        const auto path = bench::WriteSized("libcfg_bench_diff.yaml", size);
+        const cfg::ConfigBase older = cfg::GetConfig_From(path).value();
+        std::ofstream(path, std::ios::app) << "extra: 1\n";
+        const cfg::ConfigBase newer = cfg::GetConfig_From(path).value();
+        const std::string params = "/size:" + bench::SizeName(size);
+        reporter.Measure("config_diff/load" + params, [&]()
+                         { bench::DoNotOptimize(cfg::GetConfig_From(path)); });
+        // Hashes both versions on the first diff, and the newer version on every reload
+        reporter.Measure("config_diff/load_and_diff" + params, [&]()
+                         { bench::DoNotOptimize(older.Diff(cfg::GetConfig_From(path).value())); });
+        reporter.Measure("config_diff/diff" + params, [&]()
+                         { bench::DoNotOptimize(older.Diff(newer)); });
+        std::filesystem::remove(path);
+    }
+}
+
+BENCH_CASE(commit)
+{
+    for (uint64_t size : {uint64_t(64) << 10, uint64_t(1) << 20})
+    {
+        if (size > bench::GlobalOptions().max_size)
+        {
+            break;
+        }
+        const auto path = bench::WriteSized("libcfg_bench_commit.yaml", size);
+        const std::string params = "/size:" + bench::SizeName(size);
+        std::unique_ptr<cfg::WritableConfig> writable = cfg::GetWritableConfig_From(path);
+        int value = 0;
+        reporter.Measure("commit/single" + params, [&]()
+                         {
+            writable->Set("section0.limits.upper", ++value);
+            bench::DoNotOptimize(writable->Commit()); });
+        // A thousand changes of different keys in a single commit, which patches all of them into the text
+        reporter.Measure("commit/batch:1000" + params, [&]()
+                         {
+            ++value;
+            for (int idx = 0; idx < 1000; idx++)
+            {
+                writable->Set("section" + std::to_string(idx) + ".limits.upper", value);
+            }
+            bench::DoNotOptimize(writable->Commit()); });
+        // Values of block sequences cannot be patched, hence the whole config is emitted
+        reporter.Measure("commit/emit" + params, [&]()
+                         {
+            writable->Set("section0.limits", std::vector<int>{++value});
+            bench::DoNotOptimize(writable->Commit()); });
+        writable.reset();
+        std::filesystem::remove(path);
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef GENERATE_HPP
+#define GENERATE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace bench
+{
+    /// @brief Generates a nested config, in which every level holds a few sibling scalars, a `leaf` scalar and
+    /// a `next` map for the following level, e.g. `next.next.leaf` refers to a value at depth 3.
+    /// @param depth deepest level of the config
+    /// @param width number of sibling scalars at each level
+    inline std::string GenerateNested(size_t depth, size_t width)
+    {
+        std::ostringstream out;
+        for (size_t level = 0; level < depth; level++)
+        {
+            const std::string indent(level * 2, ' ');
+            for (size_t idx = 0; idx < width; idx++)
+            {
+                out << indent << "sibling" << idx << ": " << idx << '\n';
+            }
+            out << indent << "leaf: " << level + 1 << ".5\n";
+            out << indent << "next:\n";
+        }
+        out << std::string(depth * 2, ' ') << "leaf: 0.0\n";
+        return out.str();
+    }
+
+    /// @brief Combined key referring to the leaf value at the given depth of a config generated by GenerateNested
+    inline std::string NestedKey(size_t depth, std::string const &leaf = "leaf")
+    {
+        std::string key;
+        for (size_t level = 1; level < depth; level++)
+        {
+            key += "next.";
+        }
+        return key + leaf;
+    }
+
+    /// @brief Generates a config with a single `section` map of the given width, holding keys `key0`, `key1`, ...
+    inline std::string GenerateWide(size_t width)
+    {
+        std::ostringstream out;
+        out << "section:\n";
+        for (size_t idx = 0; idx < width; idx++)
+        {
+            out << "  key" << idx << ": " << idx << ".5\n";
+        }
+        return out.str();
+    }
+
+    /// @brief Writes a config of at least the given size into a file in the temporary directory. The config
+    /// consists of repeated sections mixing nested maps, scalars of different types and short sequences, which
+    /// resembles typical application configs.
+    /// @param name file name
+    /// @param bytes minimum size of the config
+    /// @return absolute path to the written file
+    inline std::filesystem::path WriteSized(std::string const &name, uint64_t bytes)
+    {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        for (uint64_t section = 0; uint64_t(out.tellp()) < bytes; section++)
+        {
+            out << "section" << section << ":\n"
+                << "  name: \"section number " << section << "\"\n"
+                << "  enabled: " << (section % 2 == 0 ? "true" : "false") << '\n'
+                << "  weight: " << section << ".25\n"
+                << "  dims: [" << section << ".5, 12.0, 5.1]\n"
+                << "  color: [255, " << section % 256 << ", 64]\n"
+                << "  limits:\n"
+                << "    lower: -" << section << '\n'
+                << "    upper: " << section * 2 << '\n';
+        }
+        return std::filesystem::absolute(path);
+    }
+
+    /// @brief Human readable size, used in case names
+    inline std::string SizeName(uint64_t bytes)
+    {
+        if (bytes >= (uint64_t(1) << 20))
+        {
+            return std::to_string(bytes >> 20) + "MB";
+        }
+        return std::to_string(bytes >> 10) + "KB";
+    }
+} // namespace bench
+
+#endif // GENERATE_HPP
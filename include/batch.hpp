@@ -0,0 +1,175 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <yaml-cpp/yaml.h>
+
+#include "image.hpp"
+#include "index.hpp"
+#include "result.hpp"
+
+namespace cfg
+{
+    class Batch;
+    class BatchResult;
+    class ConfigBase;
+
+    namespace detail
+    {
+        /// @brief Node a batched key resolved to, in either a node tree or a compiled config image. Both are null
+        /// if the key is missing.
+        struct BatchNode
+        {
+            YAML::Node const *node;      // Resolved node of a node tree
+            Image const *image;          // Compiled config image, the key is resolved against
+            ImageNode const *image_node; // Resolved node of a compiled config image
+        };
+
+        /// @brief Type-erased decoded value of a batched key
+        struct BatchValue
+        {
+            const std::type_index type; // Value type, which the key is decoded to
+            const Error error;          // Reason, why the value cannot be obtained, Error::None on success
+
+            BatchValue(std::type_index _type, Error _error)
+                : type(_type), error(_error) {}
+            virtual ~BatchValue() = default;
+        };
+
+        /// @brief Decoded value of a batched key of a particular type
+        template <typename T>
+        struct TypedBatchValue : public BatchValue
+        {
+            const boost::optional<T> value; // Decoded value, none if the key is missing or cannot be decoded
+
+            explicit TypedBatchValue(Result<T> &&_result)
+                : BatchValue(typeid(T), _result.error()), value(std::move(_result).optional()) {}
+        };
+
+        /// @brief Decodes the node of a batched key to the requested type. Defined along with cfg::ConfigBase,
+        /// which implements decoding.
+        template <typename T>
+        std::unique_ptr<BatchValue> DecodeBatchValue(BatchNode const &node);
+    } // namespace detail
+
+    /// @brief Typed handle of a key added to a cfg::Batch, which is used to read its value from a cfg::BatchResult
+    /// @tparam T configuration value type
+    template <typename T>
+    class Slot
+    {
+        uint32_t _idx; // Position of the key in the batch
+
+        explicit Slot(uint32_t _idx)
+            : _idx(_idx) {}
+
+    public:
+        friend class Batch;
+        friend class BatchResult;
+        friend class ConfigBase;
+    };
+
+    /// @brief Group of config keys, which are looked up together using cfg::ConfigBase::Get(cfg::Batch const &).
+    /// Keys are arranged in a trie of their dot '.'-separated key segments, so that a lookup walks every shared
+    /// prefix of the keys only once and scans every map along the way only once, no matter how many keys share it.
+    /// A batch is built once and can be looked up any number of times against any config.
+    class Batch
+    {
+        /// @brief Node of the key segment trie
+        struct Trie
+        {
+            std::string segment;            // Key segment leading to the node
+            std::vector<uint32_t> children; // Child nodes, one per distinct following key segment, sorted by segment
+            std::vector<uint32_t> slots;    // Keys ending at the node
+        };
+
+        /// @brief Decodes the node of a key to its value type
+        using Decoder = std::unique_ptr<detail::BatchValue> (*)(detail::BatchNode const &);
+
+        /// @brief Key added to the batch along with its value type
+        struct Request
+        {
+            std::string key; // Combined key string
+            uint64_t hash;   // Hash of the combined key
+            Decoder decode;  // Decodes the value of the key
+        };
+
+        std::vector<Trie> _trie;        // Key segment trie, the first node being the root
+        std::vector<Request> _requests; // Keys in the order they are added
+
+        /// @brief Inserts a key into the key segment trie
+        void insert(std::string_view _key, uint32_t _slot);
+
+        /// @brief Adds a key along with its precomputed hash to the batch
+        template <typename T>
+        Slot<T> add(std::string_view _key, uint64_t _hash)
+        {
+            const uint32_t slot = static_cast<uint32_t>(_requests.size());
+            _requests.push_back(Request{std::string(_key), _hash, &detail::DecodeBatchValue<T>});
+            insert(_key, slot);
+            return Slot<T>(slot);
+        }
+
+    public:
+        Batch()
+            : _trie(1) {}
+
+        /// @brief Adds a key to the batch
+        /// @tparam T configuration value type
+        /// @param key config key
+        /// @return handle to read the value of the key from the batch result
+        template <typename T>
+        Slot<T> Add(std::string const &key)
+        {
+            return add<T>(key, detail::Hash(key));
+        }
+
+        /// @brief Number of keys in the batch
+        inline size_t Size() const
+        {
+            return _requests.size();
+        }
+
+        friend class ConfigBase;
+    };
+
+    /// @brief Values of all keys of a cfg::Batch, as looked up together by cfg::ConfigBase::Get(cfg::Batch const &)
+    class BatchResult
+    {
+        std::vector<std::unique_ptr<detail::BatchValue>> _values; // Decoded values in the order of the batch
+        std::vector<bool> _found;                                  // Whether keys are present in the config
+
+        explicit BatchResult(size_t _size)
+            : _values(_size), _found(_size, false) {}
+
+    public:
+        /// @brief Value of a key of the batch
+        /// @return optional value, none if the key is missing, null or cannot be decoded to the value type
+        template <typename T>
+        boost::optional<T> const &Get(Slot<T> const &slot) const
+        {
+            assert(slot._idx < _values.size() && _values[slot._idx]->type == typeid(T));
+            return static_cast<detail::TypedBatchValue<T> const &>(*_values[slot._idx]).value;
+        }
+
+        /// @brief Whether a key of the batch is present in the config, which tells missing keys apart from the
+        /// ones, whose value is null or cannot be decoded to the value type
+        template <typename T>
+        bool Found(Slot<T> const &slot) const
+        {
+            assert(slot._idx < _found.size());
+            return _found[slot._idx];
+        }
+
+        friend class ConfigBase;
+    };
+} // namespace cfg
+
+#endif // BATCH_HPP
@@ -0,0 +1,105 @@
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "index.hpp"
+#include "result.hpp"
+
+namespace cfg
+{
+    namespace detail
+    {
+        /// @brief Memoizes decoded config values against their key and value type. Every value is decoded at most
+        /// once (barring concurrent first lookups) and kept at a stable address for the lifetime of the cache,
+        /// hence it can be handed out by const reference. Failed lookups are memoized as well, along with the reason of the
+        /// failure.
+        class ValueCache
+        {
+            /// @brief Type-erased cache entry
+            struct Entry
+            {
+                std::string key;      // Combined key of the config value
+                std::type_index type; // Config value type
+
+                Entry(std::string_view _key, std::type_index _type)
+                    : key(_key), type(_type) {}
+                virtual ~Entry() = default;
+            };
+
+            /// @brief Cache entry holding a decoded config value
+            template <typename T>
+            struct Value : Entry
+            {
+                const Result<T> value; // Decoded config value, or the reason why the lookup has failed
+
+                Value(std::string_view _key, Result<T> &&_value)
+                    : Entry(_key, typeid(T)), value(std::move(_value)) {}
+            };
+
+            mutable std::shared_mutex _mutex; // Guards the entries
+            mutable std::unordered_map<uint64_t, std::vector<std::unique_ptr<Entry>>> _entries; // Entries by hash
+
+            /// @brief Looks up the entry of a key and type within the bucket of their combined hash
+            static Entry const *find(std::vector<std::unique_ptr<Entry>> const &bucket, std::string_view key,
+                                     std::type_index type)
+            {
+                for (std::unique_ptr<Entry> const &entry : bucket)
+                {
+                    if (entry->type == type && entry->key == key)
+                    {
+                        return entry.get();
+                    }
+                }
+                return nullptr;
+            }
+
+        public:
+            /// @brief Looks up the memoized value of a key and type, decoding and memoizing it on first lookup
+            /// @tparam T config value type
+            /// @param key combined key
+            /// @param hash hash of the combined key
+            /// @param decode callable returning cfg::Result<T>, invoked on first lookup
+            /// @return memoized value, which remains valid for the lifetime of the cache
+            template <typename T, typename Decode>
+            Result<T> const &Find(std::string_view key, uint64_t hash, Decode &&decode) const
+            {
+                const std::type_index type = typeid(T);
+                const uint64_t bucket = hash ^ type.hash_code();
+                {
+                    std::shared_lock<std::shared_mutex> lock(_mutex);
+                    auto it = _entries.find(bucket);
+                    if (it != _entries.end())
+                    {
+                        if (Entry const *entry = find(it->second, key, type))
+                        {
+                            return static_cast<Value<T> const *>(entry)->value;
+                        }
+                    }
+                }
+                // Decode outside of the lock, a concurrent first lookup of the same value may decode it as well
+                auto value = std::make_unique<Value<T>>(key, decode());
+                std::unique_lock<std::shared_mutex> lock(_mutex);
+                std::vector<std::unique_ptr<Entry>> &entries = _entries[bucket];
+                if (Entry const *entry = find(entries, key, type))
+                {
+                    return static_cast<Value<T> const *>(entry)->value;
+                }
+                entries.push_back(std::move(value));
+                return static_cast<Value<T> const *>(entries.back().get())->value;
+            }
+        };
+    } // namespace detail
+} // namespace cfg
+
+#endif // CACHE_HPP
@@ -1,24 +1,216 @@
 #ifndef CFG_HPP
 #define CFG_HPP
 
+#include <chrono>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <queue>
+#include <vector>
 #include <filesystem>
+#include <functional>
+#include <future>
 #include <memory>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
 
 #include <boost/optional.hpp>
 #include <yaml-cpp/yaml.h>
 
+#include "batch.hpp"
+#include "cache.hpp"
+#include "diagnostics.hpp"
+#include "diff.hpp"
+#include "image.hpp"
+#include "index.hpp"
+#include "lazy.hpp"
+#include "native.hpp"
+#include "numeric.hpp"
+#include "registry.hpp"
+#include "result.hpp"
+#include "schema.hpp"
+#include "stats.hpp"
+#include "types.hpp"
+
 namespace cfg
 {
+    /// @brief Options for instantiating cfg::ConfigBase using cfg::GetConfig_From
+    struct LoadOptions
+    {
+        /// Flattens the node tree once at load time into a hashed index of combined keys, so that a lookup costs
+        /// a single hash probe irrespective of the depth of the key and the width of the maps along the way. Trades
+        /// load time and memory for lookup time, hence worthwhile for large configs read in the hot path.
+        bool flat_index = false;
+
+        /// Pre-scans the file for its top-level sections instead of parsing it, and parses every section only when
+        /// it is looked up for the first time. Cuts load time and memory for large configs, of which only a few
+        /// sections are read. Files, which cannot be split into sections without parsing them, e.g. because of
+        /// anchors and aliases, are parsed eagerly. Takes precedence over the flattened key index.
+        bool lazy = false;
+
+        /// Parses the file using a native parser of the subset of YAML, which configs commonly use, instead of
+        /// yaml-cpp, and compiles it into an in-memory compiled config image. Values and their conversions are the
+        /// same, while loading takes a fraction of the time. Files beyond the subset, e.g. with anchors, aliases,
+        /// tags or block scalars, are parsed by yaml-cpp. The lazy parse takes precedence.
+        bool native = false;
+
+        /// Stores the config compactly as an in-memory compiled config image instead of a yaml-cpp node tree. Key
+        /// segments and string values are interned into a single string pool, i.e. every distinct string is stored
+        /// once, irrespective of how often it occurs, and nodes take 32 bytes each without any heap allocation of
+        /// their own. Files of the subset of the native parser are parsed natively, any other file is parsed by
+        /// yaml-cpp and compiled afterwards. The lazy parse takes precedence.
+        bool compact = false;
+    };
+
+    /// @brief Memory footprint of a config, see cfg::ConfigBase::MemoryUsage
+    struct ConfigMemoryUsage
+    {
+        uint64_t structure = 0; // Nodes of the node tree or the compiled config image, and their numeric values
+        uint64_t strings = 0;   // Characters of keys and scalars, along with the string table of an image
+        uint64_t index = 0;     // Flattened or sorted key index
+        uint64_t text = 0;      // Mapped file text and section table of a lazily parsed config
+        bool exact = false;     // Whether the footprint is exact, or estimated from the layout of the node tree
+
+        /// @brief Memory footprint of the config in bytes
+        inline uint64_t Total() const
+        {
+            return structure + strings + index + text;
+        }
+    };
+
+    /// @brief Precompiled config key. Holds the individual key segments, which are split only once, when the key
+    /// is compiled using cfg::ConfigBase::Compile, along with the node it resolved to in the compiling config. Repeated
+    /// lookups with cfg::ConfigBase::Get<T> against the same config reuse the resolved node, while lookups against
+    /// other configs walk the node tree using the segments, without parsing the combined key string again.
+    class Key
+    {
+        /// @brief Node resolved against the root node of a particular node tree. Kept behind a shared pointer
+        /// because YAML::Node assignment rebinds the referenced node inside the tree instead of the handle.
+        struct Resolution
+        {
+            YAML::Node root;                           // Root node of the tree, the key is resolved against
+            boost::optional<YAML::Node> node;          // Resolved node, none if the key is missing in the tree
+            std::shared_ptr<const detail::Image> image; // Compiled config image, the key is resolved against
+            detail::ImageNode const *image_node;       // Resolved image node, nullptr if the key is missing
+        };
+
+        std::string _path;                          // Combined key string, which the handle is compiled from
+        std::vector<std::string> _segments;         // Key segments for individual levels of the hierarchy
+        uint64_t _hash;                             // Hash of the combined key for flattened index lookups
+        std::shared_ptr<const Resolution> _resolved; // Resolution against the tree of the compiling config
+
+        /// @brief Constructor. Defined as private because handles are meant to be compiled by cfg::ConfigBase,
+        /// which knows about the delimiter separating the key segments.
+        Key(std::string const &_key, std::vector<std::string> &&_key_segs)
+            : _path(_key), _segments(std::move(_key_segs)), _hash(detail::Hash(_key)) {}
+
+    public:
+        Key() = delete;
+
+        /// @brief Combined key string, which the handle is compiled from
+        inline std::string const &Path() const
+        {
+            return _path;
+        }
+
+        /// @brief Number of levels in the hierarchy, the key refers to
+        inline size_t Depth() const
+        {
+            return _segments.size();
+        }
+
+        friend class ConfigBase;
+    };
+
+    namespace detail
+    {
+        /// @brief Immutable snapshot of a parsed config file. A snapshot is never modified once it is built, hence
+        /// it is shared by all copies of a cfg::ConfigBase instead of parsing the file again for every copy.
+        struct Snapshot
+        {
+            const YAML::Node root;                    // Root node of the node tree, null unless parsed eagerly
+            std::shared_ptr<const FlatIndex> index;   // Flattened index of the node tree, if opted in
+            std::shared_ptr<const Image> image;       // Compiled config image, if loaded from one
+            std::shared_ptr<const LazyDocument> lazy; // Config file parsed section by section, if opted in
+            ValueCache cache;                         // Memoized config values decoded from the node tree
+            HashTreeCache hashes;                     // Content hashes of the node tree, built for diffs
+
+            /// @brief Constructor. Builds the flattened index of the node tree, if opted in.
+            Snapshot(YAML::Node const &_root, std::string const &_delimeter, LoadOptions const &_options)
+                : root(_root)
+            {
+                if (_options.flat_index)
+                {
+                    index = std::make_shared<const FlatIndex>(root, _delimeter);
+                }
+            }
+
+            /// @brief Constructor for compiled config images, which carry a sorted key index of their own
+            explicit Snapshot(std::shared_ptr<const Image> _image)
+                : root(YAML::NodeType::Null), image(std::move(_image)) {}
+
+            /// @brief Constructor for config files parsed section by section on demand
+            explicit Snapshot(std::shared_ptr<const LazyDocument> _lazy)
+                : root(YAML::NodeType::Null), lazy(std::move(_lazy)) {}
+        };
+    } // namespace detail
+
+    /// @brief Config value visited by cfg::ConfigBase::ForEach. Refers to the value inside the visited config
+    /// without copying it, hence it is valid only for the duration of the visit.
+    class ConfigValue
+    {
+        YAML::Node const *_node;              // Node of a node tree, nullptr for compiled config images
+        detail::Image const *_image;          // Compiled config image, nullptr for node trees
+        detail::ImageNode const *_image_node; // Node of the compiled config image
+
+        explicit ConfigValue(YAML::Node const &_node)
+            : _node(&_node), _image(nullptr), _image_node(nullptr) {}
+
+        ConfigValue(detail::Image const &_image, detail::ImageNode const &_image_node)
+            : _node(nullptr), _image(&_image), _image_node(&_image_node) {}
+
+    public:
+        /// @brief Converts the value to the configuration value type, like cfg::ConfigBase::TryGet<T> would
+        /// @tparam T configuration value type
+        /// @return config value, or the reason why it cannot be converted
+        template <typename T>
+        Result<T> TryGet() const;
+
+        /// @brief Converts the value to the configuration value type, like cfg::ConfigBase::Get<T> would, yet
+        /// without reporting failures
+        /// @tparam T configuration value type
+        /// @return optional config value
+        template <typename T>
+        boost::optional<T> Get() const
+        {
+            return TryGet<T>().optional();
+        }
+
+        /// @brief Whether the value is a sequence, as opposed to a scalar, a null value or an empty map
+        bool IsSequence() const;
+
+        friend class ConfigBase;
+    };
+
+    /// @brief Visitor of the values underneath a key prefix, see cfg::ConfigBase::ForEach. The combined key refers
+    /// to a buffer of the enumeration, which is valid only for the duration of the call.
+    using ConfigVisitor = std::function<void(std::string_view key, ConfigValue const &value)>;
+
     /// @brief Wraps yaml-cpp to implement a utility method to fetch config values from file.
-    /// A config file could be arbitrarily large, hence YAML::Node tree is initialized onto heap.
+    /// A config file could be arbitrarily large, hence YAML::Node tree is initialized onto heap and shared as an
+    /// immutable snapshot between the copies of a config, which makes copies cheap and free of file I/O.
+    ///
+    /// Thread safety: the read path never modifies the node tree, neither on hits nor on misses. Hence, all const
+    /// member functions can be called concurrently on the same instance and on copies sharing the same tree.
+    /// Lookups through the flattened index or a precompiled key handle touch no shared mutable state at all, while
+    /// the tree walk copies yaml-cpp node handles, which share a reference count per tree.
     class ConfigBase
     {
-        std::unique_ptr<YAML::Node> _root; // Root node of the node tree
-        std::string _delimeter;            // Separator for key segments of hierarchical config items
-        std::filesystem::path _path;       // Base path for config file
+        std::shared_ptr<const detail::Snapshot> _snapshot; // Parsed node tree shared between copies
+        std::string _delimeter;                           // Separator for key segments of hierarchical config items
+        std::filesystem::path _path;                      // Base path for config file
 
         /// @brief Parses combined key string into a queue of identifiers for individual levels in the
         /// hierarchical config structure. This is done depending on a delimiter separating the combined
@@ -39,63 +231,442 @@ namespace cfg
             return buffer;
         }
 
+        /// @brief Looks up the child of a map node against a single key segment. Unlike YAML::Node::operator[],
+        /// this neither decodes every child key into a temporary string for comparison nor allocates a
+        /// placeholder node when the key is missing. In particular, it never inserts missing keys into the tree,
+        /// like the non-const YAML::Node::operator[] does, which keeps lookups on a shared tree free of data races.
+        static boost::optional<YAML::Node> child(YAML::Node const &node, std::string_view _key_seg)
+        {
+            if (!node.IsMap())
+            {
+                return boost::none;
+            }
+            for (auto const &kv : node)
+            {
+                if (kv.first.IsScalar() && kv.first.Scalar() == _key_seg)
+                {
+                    return kv.second;
+                }
+            }
+            return boost::none;
+        }
+
         /// @brief Recursively fetches keys from hierarchical yaml nodes using key segments. Yaml-cpp supports a
         /// number of node types such as null, scalar, sequence maps etc. A map denotes existence of a single
-        /// key-value pair or nested key-value pairs. When we exhaust all key segments and currently traversed
-        /// node is not a map, it means we have reached a node which denotes a scalar, a sequence or null value,
-        /// at which point we return the node.
-        YAML::Node fetch(YAML::Node node, std::queue<std::string> &_segments) const
+        /// key-value pair or nested key-value pairs. The leading segment of the combined key is looked up among the
+        /// children of the current node, and the remainder of the key is fetched from the child. When we exhaust all
+        /// key segments we return the node, which could denote a scalar, a sequence, a map or null value.
+        static boost::optional<YAML::Node> fetch(YAML::Node const &node, std::string_view _key,
+                                                 std::string_view _delimeter)
         {
-            if (!node.IsMap() && _segments.empty())
+            const size_t end = _key.find(_delimeter);
+            boost::optional<YAML::Node> next = child(node, _key.substr(0, end));
+            if (!next.has_value() || end == std::string_view::npos)
+            {
+                return next;
+            }
+            return fetch(next.value(), _key.substr(end + _delimeter.length()), _delimeter);
+        }
+
+        /// @brief Recursively fetches keys from hierarchical yaml nodes using the segments of a precompiled key,
+        /// starting from the given level. Returns none as soon as a key segment cannot be found.
+        static boost::optional<YAML::Node> fetch(YAML::Node const &node, Key const &_key, size_t _level)
+        {
+            if (_level == _key._segments.size())
             {
                 return node;
             }
-            std::string _key_seg = _segments.front();
-            _segments.pop();
-            return fetch(node[_key_seg], _segments);
+            boost::optional<YAML::Node> next = child(node, _key._segments[_level]);
+            if (!next.has_value())
+            {
+                return boost::none;
+            }
+            return fetch(next.value(), _key, _level + 1);
+        }
+
+        /// @brief Fetches a combined key from a config parsed section by section. The leading key segment selects
+        /// the top-level section, which is parsed on first lookup, and the remainder is fetched from the section.
+        boost::optional<YAML::Node> fetchLazy(std::string_view _key) const
+        {
+            const size_t end = _key.find(_delimeter);
+            boost::optional<YAML::Node> section = _snapshot->lazy->Section(_key.substr(0, end));
+            if (!section.has_value() || end == std::string_view::npos)
+            {
+                return section;
+            }
+            return fetch(section.value(), _key.substr(end + _delimeter.length()), _delimeter);
+        }
+
+        /// @brief Fetches a precompiled key from a config parsed section by section
+        boost::optional<YAML::Node> fetchLazy(Key const &_key) const
+        {
+            boost::optional<YAML::Node> section = _snapshot->lazy->Section(_key._segments.front());
+            return section.has_value() ? fetch(section.value(), _key, 1) : boost::none;
+        }
+
+        /// @brief Walks the node tree along the key segment trie of a batch, starting from the given trie node, and
+        /// decodes the keys ending along the way. Every map is scanned once for all trie children at once.
+        void walk(Batch const &_batch, uint32_t _trie, YAML::Node const &node, BatchResult &_result) const;
+
+        /// @brief Collects the combined keys of all values of the config, i.e. of nodes other than non-empty maps,
+        /// which are neither read themselves nor through any of their parents
+        /// @param _read keys, which are read
+        /// @param _touched parents of the keys, which are read
+        /// @param _keys unread keys in the order of the config
+        void unread(std::unordered_set<std::string> const &_read, std::unordered_set<std::string> const &_touched,
+                    std::vector<std::string> &_keys) const;
+
+        /// @brief Content hashes of the snapshot, built once for all copies sharing it
+        detail::HashTree const &hashTree() const;
+
+        /// @brief Assigns the looked up value of a schema field to the struct, or records the key of the field as
+        /// missing or mistyped
+        template <typename S, typename M, typename T>
+        static void bindField(detail::Field<S, M> const &field, uint32_t _slot, BatchResult const &result, T &obj,
+                              BindReport &_report)
+        {
+            boost::optional<M> const &val = result.Get(Slot<M>(_slot));
+            if (val.has_value())
+            {
+                obj.*field.member = val.value();
+            }
+            else if (result.Found(Slot<M>(_slot)))
+            {
+                _report.mistyped.emplace_back(field.key);
+            }
+            else
+            {
+                _report.missing.emplace_back(field.key);
+            }
         }
 
         /// @brief Constructor. Defined as private because this can throw but we don't want to handle the error in
         /// here. Instead we want to call the constructor from api layer and wrap the error handling there.
-        explicit ConfigBase(std::filesystem::path const &_cfg_path)
+        /// Compiled config images are detected by their magic and mapped into memory instead of being parsed.
+        explicit ConfigBase(std::filesystem::path const &_cfg_path, LoadOptions const &_options = LoadOptions())
             : _delimeter("."), _path(_cfg_path)
         {
-            _root = std::make_unique<YAML::Node>();
-            *_root = YAML::LoadFile(_cfg_path);
+            if (detail::Image::Detect(_cfg_path))
+            {
+                std::shared_ptr<const detail::Image> image = detail::Image::Map(_cfg_path);
+                if (!image)
+                {
+                    throw YAML::BadFile(_cfg_path.string());
+                }
+                _snapshot = std::make_shared<const detail::Snapshot>(std::move(image));
+                return;
+            }
+            if (_options.lazy)
+            {
+                std::shared_ptr<const detail::LazyDocument> lazy = detail::LazyDocument::Scan(_cfg_path);
+                if (lazy)
+                {
+                    _snapshot = std::make_shared<const detail::Snapshot>(std::move(lazy));
+                    return;
+                }
+            }
+            if (_options.native || _options.compact)
+            {
+                std::shared_ptr<const detail::Image> image = detail::LoadNative(_cfg_path);
+                if (!image && _options.compact)
+                {
+                    image = detail::Image::FromBuffer(detail::CompileImage(YAML::LoadFile(_cfg_path)));
+                }
+                if (image)
+                {
+                    _snapshot = std::make_shared<const detail::Snapshot>(std::move(image));
+                    return;
+                }
+            }
+            _snapshot = std::make_shared<const detail::Snapshot>(YAML::LoadFile(_cfg_path), _delimeter, _options);
         }
 
-    public:
-        ConfigBase() = delete;
-        ~ConfigBase() {}
+        /// @brief Constructor for a config, whose node tree is not parsed from a single config file, e.g. because
+        /// it is merged from layered config files
+        /// @param _cfg_path path, which the config is identified by
+        /// @param _root root node of the tree
+        /// @param _options load options, of which the flattened key index applies
+        ConfigBase(std::filesystem::path const &_cfg_path, YAML::Node const &_root, LoadOptions const &_options)
+            : _snapshot(std::make_shared<const detail::Snapshot>(_root, ".", _options)), _delimeter("."),
+              _path(_cfg_path) {}
+
+        /// @brief Constructor for a config read from a compiled config image, which is not mapped from a config
+        /// file, e.g. because it is attached from shared memory
+        /// @param _cfg_path path, which the config is identified by
+        /// @param _image compiled config image
+        ConfigBase(std::filesystem::path const &_cfg_path, std::shared_ptr<const detail::Image> _image)
+            : _snapshot(std::make_shared<const detail::Snapshot>(std::move(_image))), _delimeter("."),
+              _path(_cfg_path) {}
+
+        /// @brief Converts a fetched node to the configuration value type without throwing. Numbers and sequences
+        /// of numbers are parsed without yaml-cpp's stream based conversion, and any other type is decoded using its
+        /// YAML::convert specialization directly rather than YAML::Node::as<T>, which throws on failure.
+        /// @return config value, or the reason why the node cannot be converted
+        template <typename T>
+        static Result<T> decode(YAML::Node const &val)
+        {
+            if (!val.IsDefined())
+            {
+                return Error::Missing;
+            }
+            if (val.IsNull())
+            {
+                return Error::Null;
+            }
+            if constexpr (std::is_same_v<T, std::string_view>)
+            {
+                // Refers to the scalar inside the node tree, which lives as long as the snapshot
+                if (val.IsScalar())
+                {
+                    return std::string_view(val.Scalar());
+                }
+            }
+            else if constexpr (detail::IsNumber<T>)
+            {
+                T num{};
+                if (val.IsScalar() && detail::ParseNumber(val.Scalar(), num))
+                {
+                    return num;
+                }
+            }
+            else if constexpr (detail::IsNumberVector<T>)
+            {
+                T nums;
+                if (detail::DecodeNumbers(val, nums))
+                {
+                    return nums;
+                }
+            }
+            else
+            {
+                if constexpr (detail::FixedLength<T> > 0)
+                {
+                    if (val.IsSequence() && val.size() != detail::FixedLength<T>)
+                    {
+                        return Error::BadLength;
+                    }
+                }
+                try
+                {
+                    T value{};
+                    if (YAML::convert<T>::decode(val, value))
+                    {
+                        return value;
+                    }
+                }
+                catch (YAML::Exception const &)
+                {
+                    // Conversions of nested types provided by yaml-cpp, e.g. std::vector<std::string>, may still throw
+                }
+            }
+            return Error::TypeMismatch;
+        }
+
+        /// @brief Reports failures to decode a config value to the diagnostics sink, while missing and null values
+        /// are not reported
+        static void report(Error error, std::string const &key)
+        {
+            if (error == Error::TypeMismatch || error == Error::BadLength)
+            {
+                detail::Report("Cannot decode config value " + key + ": " + std::string(ToString(error)));
+            }
+        }
+
+        /// @brief Reports failures to decode a config value, see above
+        /// @return config value as optional
+        template <typename T>
+        static boost::optional<T> report(Result<T> &&result, std::string const &key)
+        {
+            report(result.error(), key);
+            return std::move(result).optional();
+        }
+
+        /// @brief Looks up a config value against the specified key, see cfg::ConfigBase::TryGet
+        template <typename T>
+        Result<T> lookup(std::string const &key) const
+        {
+            if (_snapshot->image)
+            {
+                detail::ImageNode const *val = _snapshot->image->Find(key);
+                return val != nullptr ? decode<T>(*_snapshot->image, *val) : Error::Missing;
+            }
+            if (_snapshot->index)
+            {
+                YAML::Node const *val = _snapshot->index->Find(key);
+                return val != nullptr ? decode<T>(*val) : Error::Missing;
+            }
+            boost::optional<YAML::Node> val =
+                _snapshot->lazy ? fetchLazy(key) : fetch(_snapshot->root, key, _delimeter);
+            return val.has_value() ? decode<T>(val.value()) : Error::Missing;
+        }
+
+        /// @brief Looks up a config value against a precompiled key handle, see cfg::ConfigBase::TryGet
+        template <typename T>
+        Result<T> lookup(Key const &key) const
+        {
+            if (_snapshot->image)
+            {
+                detail::ImageNode const *val = key._resolved->image == _snapshot->image
+                                                   ? key._resolved->image_node
+                                                   : _snapshot->image->Find(key._path);
+                return val != nullptr ? decode<T>(*_snapshot->image, *val) : Error::Missing;
+            }
+            if (key._resolved->root.is(_snapshot->root))
+            {
+                return key._resolved->node.has_value() ? decode<T>(key._resolved->node.value()) : Error::Missing;
+            }
+            if (_snapshot->index)
+            {
+                YAML::Node const *val = _snapshot->index->Find(key._path, key._hash);
+                return val != nullptr ? decode<T>(*val) : Error::Missing;
+            }
+            boost::optional<YAML::Node> val = _snapshot->lazy ? fetchLazy(key) : fetch(_snapshot->root, key, 0);
+            return val.has_value() ? decode<T>(val.value()) : Error::Missing;
+        }
 
-        /// @brief Copy constructor
-        ConfigBase(ConfigBase const &_other)
-            : _delimeter(_other._delimeter), _path(_other._path)
+        /// @brief Times a lookup and records it into the access statistics, if the library is built with
+        /// CFG_WITH_INSTRUMENTATION. Otherwise, merely performs the lookup at no extra cost.
+        template <typename T, typename Lookup>
+        Result<T> instrument(std::string_view _key, Lookup &&_lookup) const
         {
-            _root.release();
-            _root = std::make_unique<YAML::Node>();
-            *_root = YAML::LoadFile(_path);
+#ifdef CFG_WITH_INSTRUMENTATION
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            Result<T> result = _lookup();
+            const std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+            detail::Record(_path, _key, result.error(), static_cast<uint64_t>(elapsed.count()));
+            return result;
+#else
+            (void)_key;
+            return _lookup();
+#endif
         }
 
-        /// @brief Copy assignment operator overload
-        ConfigBase operator=(ConfigBase const &_other)
+        /// @brief Converts a scalar node of a compiled config image to a number. Integers and doubles are taken
+        /// from the typed values decoded at compile time, any other number is parsed from the scalar.
+        /// @return number, none without reporting a failure
+        template <typename T>
+        static boost::optional<T> decodeNumber(detail::Image const &image, detail::ImageNode const &node)
         {
-            if (*this == _other)
+            if (node.type != detail::IMAGE_SCALAR)
+            {
+                return boost::none;
+            }
+            if constexpr (std::is_integral_v<T>)
+            {
+                // Unsigned types reject a leading minus sign like yaml-cpp does, even for zero
+                const bool in_range = node.i >= int64_t(std::numeric_limits<T>::min()) &&
+                                      (node.i < 0 || uint64_t(node.i) <= uint64_t(std::numeric_limits<T>::max()));
+                if ((node.flags & detail::IMAGE_HAS_INT) && in_range &&
+                    (std::is_signed_v<T> || image.String(node.value).front() != '-'))
+                {
+                    return static_cast<T>(node.i);
+                }
+            }
+            else if constexpr (std::is_same_v<T, double>)
+            {
+                if (node.flags & detail::IMAGE_HAS_FLOAT)
+                {
+                    return node.f;
+                }
+            }
+            T num{};
+            if (detail::ParseNumber(std::string(image.String(node.value)), num))
+            {
+                return num;
+            }
+            return boost::none;
+        }
+
+        /// @brief Converts a node of a compiled config image to the configuration value type. Booleans, numbers,
+        /// strings and sequences of numbers are decoded straight from the image, where sequences of doubles are
+        /// copied from contiguous numeric arrays. Any other type, as well as any failure, is decoded from a
+        /// materialized node tree, which yields exactly the same values and failures as the parsed config file.
+        template <typename T>
+        static Result<T> decode(detail::Image const &image, detail::ImageNode const &node)
+        {
+            if (node.type == detail::IMAGE_NULL)
+            {
+                return Error::Null;
+            }
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                if (node.flags & detail::IMAGE_HAS_BOOL)
+                {
+                    return (node.flags & detail::IMAGE_BOOL_VALUE) != 0;
+                }
+            }
+            else if constexpr (detail::IsNumber<T>)
             {
-                return *this;
+                boost::optional<T> num = decodeNumber<T>(image, node);
+                if (num.has_value())
+                {
+                    return num.value();
+                }
+            }
+            else if constexpr (std::is_same_v<T, std::string>)
+            {
+                if (node.type == detail::IMAGE_SCALAR)
+                {
+                    return std::string(image.String(node.value));
+                }
+            }
+            else if constexpr (std::is_same_v<T, std::string_view>)
+            {
+                // Refers to the interned string inside the image, which lives as long as the snapshot
+                if (node.type == detail::IMAGE_SCALAR)
+                {
+                    return image.String(node.value);
+                }
+                return Error::TypeMismatch;
             }
-            _delimeter = _other._delimeter;
-            _path = _other._path;
-            _root.release();
-            _root = std::make_unique<YAML::Node>();
-            *_root = YAML::LoadFile(_path);
-            return *this;
+            else if constexpr (detail::IsNumberVector<T>)
+            {
+                using Number = typename T::value_type;
+                if constexpr (std::is_same_v<Number, double>)
+                {
+                    if (node.flags & detail::IMAGE_NUMERIC_SEQ)
+                    {
+                        return T(image.Numbers(node), image.Numbers(node) + node.count);
+                    }
+                }
+                if (node.type == detail::IMAGE_SEQUENCE)
+                {
+                    T nums;
+                    nums.reserve(node.count);
+                    for (uint32_t idx = 0; idx < node.count; idx++)
+                    {
+                        boost::optional<Number> num = decodeNumber<Number>(image, image.Child(node, idx));
+                        if (!num.has_value())
+                        {
+                            break;
+                        }
+                        nums.push_back(num.value());
+                    }
+                    if (nums.size() == node.count)
+                    {
+                        return nums;
+                    }
+                }
+            }
+            return decode<T>(image.Materialize(node));
         }
 
+    public:
+        ConfigBase() = delete;
+        ~ConfigBase() {}
+
+        /// @brief Copy constructor. Shares the parsed snapshot of the other config, hence the copy neither reads
+        /// the file again nor picks up any change made to the file in the meantime.
+        ConfigBase(ConfigBase const &_other) = default;
+
+        /// @brief Copy assignment operator overload. Shares the parsed snapshot of the other config.
+        ConfigBase &operator=(ConfigBase const &_other) = default;
+
         /// @brief Equality operator overload
         inline bool operator==(cfg::ConfigBase const &_other) const
         {
-            return _delimeter == _other._delimeter && _path == _other._path && _root->Type() == _other._root->Type();
+            return _delimeter == _other._delimeter && _path == _other._path &&
+                   _snapshot->root.Type() == _other._snapshot->root.Type();
         }
 
         /// @brief Inequality operator overload
@@ -104,52 +675,348 @@ namespace cfg
             return !(*this == _other);
         }
 
+        /// @brief Structural difference from this config to another one, e.g. from the previous to the current
+        /// version of a config file. Both configs are hashed subtree by subtree once per snapshot, after which the
+        /// comparison descends only into the subtrees, whose content differs. Hence, the cost of a diff is
+        /// proportional to the size of the changes. Configs sharing their snapshot are equal without any hashing.
+        /// @param _other newer config
+        /// @return added, removed and modified keys
+        ConfigDiff Diff(ConfigBase const &_other) const;
+
         /// @brief Common accessor api for config values against specified key. Key could be a simple one referring
         /// to a root-level configuration. It can also be a dot '.'-separated combination key-segments referring to a
-        /// hierarchical combination.
+        /// hierarchical combination. Values, which cannot be decoded, are reported to the diagnostics sink.
         /// @tparam T configuration value type
         /// @param key config key
         /// @return optional config value
         template <typename T>
         boost::optional<T> Get(std::string const &key) const
         {
-            try
+            return report(TryGet<T>(key), key);
+        }
+
+        /// @brief Non-throwing accessor api for config values, which tells why a value cannot be obtained and
+        /// reports nothing to the diagnostics sink. Suited to probe optional keys or fall back to other types.
+        /// @tparam T configuration value type
+        /// @param key config key
+        /// @return config value, or the reason why it cannot be obtained
+        template <typename T>
+        Result<T> TryGet(std::string const &key) const
+        {
+            return instrument<T>(key, [this, &key]()
+                                 { return lookup<T>(key); });
+        }
+
+        /// @brief Compiles a combined key string into a reusable key handle. The handle can be used with
+        /// cfg::ConfigBase::Get<T> repeatedly, without parsing the key string on every lookup.
+        /// @param key config key
+        /// @return precompiled key handle
+        Key Compile(std::string const &key) const
+        {
+            std::queue<std::string> _queue = parseConfig(key);
+            std::vector<std::string> _segments;
+            _segments.reserve(_queue.size());
+            while (!_queue.empty())
             {
-                if (key.find(_delimeter) == std::string::npos)
-                {
-                    if (!(*_root)[key].IsDefined() || (*_root).IsNull())
-                    {
-                        return boost::none;
-                    }
-                    return (*_root)[key].as<T>();
-                }
-                std::queue<std::string> _segments = parseConfig(key);
-                // At this point key segments must not be empty
-                assert(!_segments.empty());
-                YAML::Node val = fetch((*_root), _segments);
-                if (!val.IsDefined() || val.IsNull())
-                {
-                    return boost::none;
-                }
-                return val.as<T>();
+                _segments.push_back(std::move(_queue.front()));
+                _queue.pop();
             }
-            catch (YAML::BadConversion const &bc)
+            Key _key(key, std::move(_segments));
+            if (_snapshot->image)
             {
-                std::cerr << bc.what() << '\n';
-                return boost::none;
+                _key._resolved = std::make_shared<const Key::Resolution>(
+                    Key::Resolution{_snapshot->root, boost::none, _snapshot->image, _snapshot->image->Find(key)});
+                return _key;
             }
+            _key._resolved = std::make_shared<const Key::Resolution>(
+                Key::Resolution{_snapshot->root, _snapshot->lazy ? fetchLazy(_key) : fetch(_snapshot->root, _key, 0),
+                                nullptr, nullptr});
+            return _key;
+        }
+
+        /// @brief Accessor api for config values against a precompiled key handle. Reuses the node, the handle
+        /// has resolved to, if it is compiled by a config sharing the same node tree. Otherwise, probes the flattened
+        /// index using the precomputed hash of the key, or walks the node tree using the key segments of the handle.
+        /// Neither parses the key nor allocates on the lookup path.
+        /// @tparam T configuration value type
+        /// @param key precompiled config key
+        /// @return optional config value
+        template <typename T>
+        boost::optional<T> Get(Key const &key) const
+        {
+            return report(TryGet<T>(key), key._path);
+        }
+
+        /// @brief Non-throwing accessor api for config values against a precompiled key handle
+        /// @tparam T configuration value type
+        /// @param key precompiled config key
+        /// @return config value, or the reason why it cannot be obtained
+        template <typename T>
+        Result<T> TryGet(Key const &key) const
+        {
+            return instrument<T>(key._path, [this, &key]()
+                                 { return lookup<T>(key); });
+        }
+
+        /// @brief Accessor api for a group of config values, which are looked up together. Walks every key prefix
+        /// shared by the keys of the batch only once, instead of walking the node tree from the root for every key.
+        /// @param batch keys along with their value types
+        /// @return values and presence of all keys of the batch
+        BatchResult Get(Batch const &batch) const;
+
+        /// @brief Binds all fields of a struct to the config at once, according to the schema declared for the struct
+        /// using CFG_SCHEMA. The keys of the schema are arranged into a cfg::Batch once per struct type, so that
+        /// the whole struct is filled in a single traversal of the node tree. Fields, which cannot be bound, retain
+        /// their values, e.g. default member initializers, and are reported together.
+        /// @tparam T struct type
+        /// @param obj struct to be filled
+        /// @return keys of the fields, which are missing or cannot be decoded to the field type
+        template <typename T>
+        BindReport Bind(T &obj) const
+        {
+            static_assert(detail::HasSchema<T>, "config schema of the type must be declared using CFG_SCHEMA");
+            constexpr auto fields = CfgSchema(static_cast<T const *>(nullptr));
+            static const Batch batch = std::apply([](auto const &...field)
+                                                  {
+                                                      Batch keys;
+                                                      (keys.add<typename std::decay_t<decltype(field)>::Type>(
+                                                           field.key, field.hash),
+                                                       ...);
+                                                      return keys; },
+                                                  fields);
+            const BatchResult result = Get(batch);
+            BindReport report;
+            uint32_t slot = 0;
+            std::apply([&](auto const &...field)
+                       { (bindField(field, slot++, result, obj, report), ...); },
+                       fields);
+            return report;
+        }
+
+        /// @brief Accessor api for sequences of numbers of arbitrary length, e.g. lookup curves or weight vectors.
+        /// Numbers are parsed using std::from_chars into a contiguous buffer, with the same results as yaml-cpp's
+        /// conversion. Against a compiled config image, sequences of doubles are copied from the image in one go.
+        /// Use cfg::ConfigBase::Cached<std::vector<T>> to decode a sequence once and read it by reference.
+        /// @tparam T number type
+        /// @param key config key
+        /// @return optional contiguous buffer of numbers
+        template <typename T>
+        boost::optional<std::vector<T>> GetArray(std::string const &key) const
+        {
+            static_assert(std::is_arithmetic_v<T>, "array elements must be numbers");
+            return Get<std::vector<T>>(key);
+        }
+
+        /// @brief Accessor api for sequences of numbers of arbitrary length against a precompiled key handle
+        template <typename T>
+        boost::optional<std::vector<T>> GetArray(Key const &key) const
+        {
+            static_assert(std::is_arithmetic_v<T>, "array elements must be numbers");
+            return Get<std::vector<T>>(key);
+        }
+
+        /// @brief Accessor api for two-dimensional tables of numbers, e.g. calibration matrices, given as a sequence
+        /// of equally long sequences of numbers. Rows of different lengths yield none.
+        /// @tparam T number type
+        /// @param key config key
+        /// @return optional matrix with elements in row-major order
+        template <typename T>
+        boost::optional<Matrix<T>> GetMatrix(std::string const &key) const
+        {
+            return Get<Matrix<T>>(key);
+        }
+
+        /// @brief Accessor api for two-dimensional tables of numbers against a precompiled key handle
+        template <typename T>
+        boost::optional<Matrix<T>> GetMatrix(Key const &key) const
+        {
+            return Get<Matrix<T>>(key);
+        }
+
+        /// @brief Accessor api for memoized config values. A config value is decoded on the first lookup of a key
+        /// with a given type and memoized along with the parsed config, which is shared by all copies of the config.
+        /// Subsequent lookups return the memoized value by const reference, without decoding or copying it again.
+        /// Failed lookups are memoized as well, along with the reason of the failure, which the access statistics
+        /// record like they do for cfg::ConfigBase::Get.
+        /// @tparam T configuration value type
+        /// @param key config key
+        /// @return optional reference to the config value, which remains valid as long as the config or any of
+        /// its copies exists
+        template <typename T>
+        boost::optional<T const &> Cached(std::string const &key) const
+        {
+#ifdef CFG_WITH_INSTRUMENTATION
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+#endif
+            Result<T> const &val = _snapshot->cache.Find<T>(key, detail::Hash(key), [this, &key]()
+                                                            {
+                Result<T> result = lookup<T>(key);
+                report(result.error(), key);
+                return result; });
+#ifdef CFG_WITH_INSTRUMENTATION
+            const std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+            detail::Record(_path, key, val.error(), static_cast<uint64_t>(elapsed.count()));
+#endif
+            return val.has_value() ? boost::optional<T const &>(val.value()) : boost::none;
+        }
+
+        /// @brief Accessor api for memoized config values against a precompiled key handle
+        /// @tparam T configuration value type
+        /// @param key precompiled config key
+        /// @return optional reference to the config value, which remains valid as long as the config or any of
+        /// its copies exists
+        template <typename T>
+        boost::optional<T const &> Cached(Key const &key) const
+        {
+#ifdef CFG_WITH_INSTRUMENTATION
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+#endif
+            Result<T> const &val = _snapshot->cache.Find<T>(key._path, key._hash, [this, &key]()
+                                                            {
+                Result<T> result = lookup<T>(key);
+                report(result.error(), key._path);
+                return result; });
+#ifdef CFG_WITH_INSTRUMENTATION
+            const std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+            detail::Record(_path, key._path, val.error(), static_cast<uint64_t>(elapsed.count()));
+#endif
+            return val.has_value() ? boost::optional<T const &>(val.value()) : boost::none;
         }
 
+        /// @brief Report of the accesses to the keys of the config, as recorded by the instrumentation, which is
+        /// enabled by building the library with CFG_WITH_INSTRUMENTATION. Access statistics are recorded per thread
+        /// and process-wide, and merged when the report is requested. The report covers the reads of all configs
+        /// loaded from the same path as this one, i.e. its copies and versions, but no other configs, even if they
+        /// share key names. Keys of the config, neither read themselves nor through any of their parents, are
+        /// reported as unread, where top-level sections of a lazily parsed config, which have never been looked up,
+        /// are reported as a whole.
+        /// @param top_n number of most read keys to report
+        /// @return access report, empty unless the instrumentation is enabled
+        AccessReport AccessStats(size_t top_n = 10) const;
+
+        /// @brief Enumerates the values underneath a key prefix in depth-first order. Maps are descended into,
+        /// while any other value, i.e. a scalar, a sequence, a null value or an empty map, is visited along with its
+        /// combined key. The combined key is built in a single buffer, and values are visited in place, hence the
+        /// enumeration costs time proportional to the size of the subtree. Keys, which cannot be looked up by a
+        /// combined key, because they contain the delimiter or are not scalars, are skipped. Enumerating all values of
+        /// a lazily parsed config parses every section.
+        /// @param prefix combined key of the subtree, empty for the whole config
+        /// @param visitor called with every value and its combined key
+        /// @return number of visited values, 0 if the prefix cannot be found
+        size_t ForEach(std::string const &prefix, ConfigVisitor const &visitor) const;
+
+        /// @brief Combined keys of the values underneath a key prefix, see cfg::ConfigBase::ForEach
+        /// @param prefix combined key of the subtree, empty for the whole config
+        /// @return combined keys in depth-first order, empty if the prefix cannot be found
+        std::vector<std::string> Keys(std::string const &prefix = "") const;
+
+        /// @brief Memory footprint of the config, shared by all of its copies. The footprint of a compiled config
+        /// image, i.e. of a config loaded compactly, natively or from an image file, is exact. The footprint of a
+        /// yaml-cpp node tree is estimated from the sizes of its nodes, strings and containers, including the
+        /// bookkeeping of the allocator, as yaml-cpp does not expose its allocations. Memoized config values and
+        /// content hashes built for diffs are not included, nor are sections of a lazily parsed config, which are
+        /// parsed on demand.
+        /// @return memory footprint by category
+        ConfigMemoryUsage MemoryUsage() const;
+
+        /// @brief Specifies the decoding of batched keys as friend function, which reuses the decoding of values.
+        template <typename T>
+        friend std::unique_ptr<detail::BatchValue> detail::DecodeBatchValue(detail::BatchNode const &node);
+
         /// @brief Specifies cfg::GetConfig_From as friend function to hide the main constructor and enforce
         /// its usage as api to instantiate cfg::ConfigBase.
         friend boost::optional<cfg::ConfigBase> GetConfig_From(std::filesystem::path const &_abs_path);
+        friend boost::optional<cfg::ConfigBase> GetConfig_From(std::filesystem::path const &_abs_path,
+                                                               LoadOptions const &_options);
+        friend boost::optional<cfg::ConfigBase> GetLayeredConfig_From(
+            std::vector<std::filesystem::path> const &_abs_paths, LoadOptions const &_options);
+
+        /// @brief Visits the values of a subtree of a node tree, see cfg::ConfigBase::ForEach
+        /// @param node root of the subtree
+        /// @param path combined key of the root, restored on return
+        /// @param visitor visitor
+        /// @return number of visited values
+        size_t forEach(YAML::Node const &node, std::string &path, ConfigVisitor const &visitor) const;
+
+        /// @brief Visits the values of a subtree of a compiled config image, see cfg::ConfigBase::ForEach
+        size_t forEach(detail::ImageNode const &node, std::string &path, ConfigVisitor const &visitor) const;
+
+        /// @brief Specifies cfg::ConfigValue as friend class, which reuses the decoding of values
+        friend class ConfigValue;
+
+        /// @brief Specifies cfg::PublishedConfig as friend class, which instantiates configs from images attached
+        /// from shared memory
+        friend class PublishedConfig;
+
+        /// @brief Specifies cfg::WritableConfig as friend class, which instantiates configs from committed node trees
+        friend class WritableConfig;
     };
 
+    template <typename T>
+    Result<T> ConfigValue::TryGet() const
+    {
+        return _node != nullptr ? ConfigBase::decode<T>(*_node) : ConfigBase::decode<T>(*_image, *_image_node);
+    }
+
+    template <typename T>
+    std::unique_ptr<detail::BatchValue> detail::DecodeBatchValue(detail::BatchNode const &node)
+    {
+        Result<T> value = Error::Missing;
+        if (node.image != nullptr && node.image_node != nullptr)
+        {
+            value = ConfigBase::decode<T>(*node.image, *node.image_node);
+        }
+        else if (node.node != nullptr)
+        {
+            value = ConfigBase::decode<T>(*node.node);
+        }
+        return std::make_unique<detail::TypedBatchValue<T>>(std::move(value));
+    }
+
     /// @brief API to instantiate cfg::ConfigBase. Initialization of ConfigBase may fail if wrong filepath or
     /// malformed config file is provided.
     /// @param _abs_path absolute path to the config file
     /// @return optional cfg::ConfigBase
     boost::optional<cfg::ConfigBase> GetConfig_From(std::filesystem::path const &_abs_path);
+
+    /// @brief API to instantiate cfg::ConfigBase with non-default load options, e.g. to opt in for the flattened
+    /// key index.
+    /// @param _abs_path absolute path to the config file
+    /// @param _options load options
+    /// @return optional cfg::ConfigBase
+    boost::optional<cfg::ConfigBase> GetConfig_From(std::filesystem::path const &_abs_path,
+                                                    LoadOptions const &_options);
+
+    /// @brief API to instantiate cfg::ConfigBase from layered config files, e.g. a base config followed by
+    /// environment, region and host overrides. The files are parsed concurrently and deep-merged into a single node
+    /// tree in the given order: maps are merged key by key, while any other value of a later file replaces the value
+    /// of an earlier one. Hence, a lookup costs the same as in a single config file. Compiled config images can be
+    /// used as layers as well, while lazy parsing does not apply.
+    /// @param _abs_paths absolute paths to the config files, from the least to the most specific one
+    /// @param _options load options
+    /// @return optional cfg::ConfigBase, none if any of the files cannot be read or is malformed
+    boost::optional<cfg::ConfigBase> GetLayeredConfig_From(std::vector<std::filesystem::path> const &_abs_paths,
+                                                           LoadOptions const &_options = LoadOptions());
+
+    /// @brief API to instantiate cfg::ConfigBase asynchronously, so that the caller can proceed with other work
+    /// while the config file is loaded. The file is read ahead by the operating system and parsed on a background
+    /// thread as it arrives. Errors are reported exactly like by cfg::GetConfig_From, i.e. through the diagnostics
+    /// sink and an empty optional rather than an exception stored in the future.
+    /// @param _abs_path absolute path to the config file
+    /// @param _options load options
+    /// @return future of the optional cfg::ConfigBase
+    std::future<boost::optional<cfg::ConfigBase>> GetConfig_FromAsync(std::filesystem::path const &_abs_path,
+                                                                      LoadOptions const &_options = LoadOptions());
+
+    /// @brief API to instantiate cfg::ConfigBase for many config files at once, waiting for all of them together.
+    /// All files are read ahead by the operating system up front and parsed concurrently by a pool of workers,
+    /// hence reading the later files overlaps parsing the earlier ones.
+    /// @param _abs_paths absolute paths to the config files
+    /// @param _options load options, applying to every file
+    /// @return optional cfg::ConfigBase per file in the given order, none for files, which cannot be read or are
+    /// malformed
+    std::vector<boost::optional<cfg::ConfigBase>> GetConfigs_From(std::vector<std::filesystem::path> const &_abs_paths,
+                                                                  LoadOptions const &_options = LoadOptions());
 } // namespace cfg
 
 #endif // CFG_HPP
\ No newline at end of file
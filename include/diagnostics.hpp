@@ -0,0 +1,25 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include <functional>
+#include <string_view>
+
+namespace cfg
+{
+    /// @brief Sink for diagnostic messages of the library, e.g. about config files, which cannot be read, or config
+    /// values, which cannot be decoded. May be called concurrently from any thread, which looks up config values.
+    using Diagnostics = std::function<void(std::string_view message)>;
+
+    /// @brief Installs the sink for diagnostic messages of the library in place of the default one, which writes
+    /// them to std::cerr. An empty sink discards all messages. Takes effect for all configs at once.
+    /// @param sink diagnostics sink
+    void SetDiagnostics(Diagnostics sink);
+
+    namespace detail
+    {
+        /// @brief Hands a diagnostic message over to the installed sink
+        void Report(std::string_view message);
+    } // namespace detail
+} // namespace cfg
+
+#endif // DIAGNOSTICS_HPP
@@ -0,0 +1,82 @@
+#ifndef DIFF_HPP
+#define DIFF_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+namespace cfg
+{
+    /// @brief Structural difference between two configs, see cfg::ConfigBase::Diff. Keys are combined keys in key
+    /// order. A subtree, which only one of the configs has, is reported by its topmost key alone.
+    struct ConfigDiff
+    {
+        std::vector<std::string> added;    // Keys, which only the newer config has
+        std::vector<std::string> removed;  // Keys, which only the older config has
+        std::vector<std::string> modified; // Keys, whose values differ, for maps only the differing keys within
+
+        /// @brief Whether the configs are equal
+        inline bool Empty() const
+        {
+            return added.empty() && removed.empty() && modified.empty();
+        }
+
+        /// @brief Whether any change affects the given key or any key underneath it, i.e. a changed key equals the
+        /// prefix, lies underneath it, or contains it within a changed subtree
+        /// @param prefix combined key, empty for any change at all
+        /// @param delimiter separator of the key segments
+        bool Touches(std::string_view prefix, std::string_view delimiter = ".") const;
+    };
+
+    namespace detail
+    {
+        /// @brief Content hashes of a node tree. Maps are kept by their keys, so that two trees can be compared
+        /// descending only into the subtrees, whose hashes differ, while all other values are represented by the
+        /// hash of their content alone. Hashes of maps do not depend on the order of their keys.
+        struct HashTree
+        {
+            uint64_t hash = 0;                                      // Content hash of the node
+            bool map = false;                                       // Whether the node is a map
+            std::vector<std::pair<std::string, HashTree>> children; // Hashes of map values, sorted by key
+
+            /// @brief Hashes a node tree. The root of a config is expected to be a map, any other root is hashed
+            /// as empty map, since it holds no config values.
+            /// @param root root node of the tree
+            static HashTree Build(YAML::Node const &root);
+        };
+
+        /// @brief Records the differences between two hash trees
+        /// @param older hash tree of the older config
+        /// @param newer hash tree of the newer config
+        /// @param key combined key of the compared nodes, empty for the root
+        /// @param delimiter separator of the key segments
+        /// @param diff difference to record into
+        void Diff(HashTree const &older, HashTree const &newer, std::string const &key, std::string const &delimiter,
+                  ConfigDiff &diff);
+
+        /// @brief Hash tree of a snapshot, built once when it is needed for the first time
+        class HashTreeCache
+        {
+            mutable std::once_flag _built;                 // Guards building the tree
+            mutable std::unique_ptr<const HashTree> _tree; // Hash tree, once built
+
+        public:
+            /// @brief Hash tree, built by the given function unless built already
+            template <typename Build>
+            HashTree const &Get(Build &&build) const
+            {
+                std::call_once(_built, [this, &build]()
+                               { _tree = std::make_unique<const HashTree>(build()); });
+                return *_tree;
+            }
+        };
+    } // namespace detail
+} // namespace cfg
+
+#endif // DIFF_HPP
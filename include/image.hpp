@@ -0,0 +1,199 @@
+#ifndef IMAGE_HPP
+#define IMAGE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+#include "mapped.hpp"
+
+namespace cfg
+{
+    namespace detail
+    {
+        /// @brief Header of a compiled config image. A compiled config image is a compact, pointer-free binary
+        /// representation of a config, which can be mapped into memory read-only and used in place. All offsets
+        /// are relative to the start of the image and all sections are aligned to 8 bytes.
+        struct ImageHeader
+        {
+            char magic[8];           // Identifies compiled config images, see IMAGE_MAGIC
+            uint32_t version;        // Format version, see IMAGE_VERSION
+            uint32_t endian;         // IMAGE_ENDIAN in the byte order of the writer
+            uint32_t node_count;     // Number of nodes, the root node being the first one
+            uint32_t string_count;   // Number of interned strings
+            uint32_t key_count;      // Number of combined keys in the sorted key index
+            uint32_t reserved;       // Reserved, zero
+            uint64_t number_count;   // Number of values in the contiguous numeric array section
+            uint64_t nodes_offset;   // Offset of the node table
+            uint64_t strings_offset; // Offset of the string table
+            uint64_t blob_offset;    // Offset of the string characters
+            uint64_t blob_size;      // Size of the string characters
+            uint64_t keys_offset;    // Offset of the sorted key index
+            uint64_t numbers_offset; // Offset of the contiguous numeric array section
+            uint64_t size;           // Size of the whole image
+        };
+
+        constexpr char IMAGE_MAGIC[8] = {'L', 'I', 'B', 'C', 'F', 'G', '\r', '\n'};
+        constexpr uint32_t IMAGE_VERSION = 1;
+        constexpr uint32_t IMAGE_ENDIAN = 0x01020304;
+        constexpr uint32_t IMAGE_NO_STRING = 0xFFFFFFFF;
+
+        /// @brief Node types of a compiled config image
+        enum ImageNodeType : uint8_t
+        {
+            IMAGE_NULL = 0,
+            IMAGE_SCALAR = 1,
+            IMAGE_SEQUENCE = 2,
+            IMAGE_MAP = 3
+        };
+
+        /// @brief Typed scalar flags of a compiled config image node. Scalar values are decoded at compile time using
+        /// the yaml-cpp conversions, hence typed values are exactly what YAML::Node::as<T> would yield.
+        enum ImageNodeFlags : uint8_t
+        {
+            IMAGE_HAS_INT = 1,     // Scalar decodes to a 64 bit integer, held by ImageNode::i
+            IMAGE_HAS_FLOAT = 2,   // Scalar decodes to a double, held by ImageNode::f
+            IMAGE_HAS_BOOL = 4,    // Scalar decodes to a boolean, held by IMAGE_BOOL_VALUE
+            IMAGE_BOOL_VALUE = 8,  // Boolean value of the scalar
+            IMAGE_NUMERIC_SEQ = 16 // Sequence of scalars decoding to doubles, held contiguously from ImageNode::i
+        };
+
+        /// @brief Node of a compiled config image. Children of a sequence or a map are stored contiguously.
+        struct ImageNode
+        {
+            uint8_t type;      // Node type, see ImageNodeType
+            uint8_t flags;     // Typed scalar flags, see ImageNodeFlags
+            uint16_t reserved; // Reserved, zero
+            uint32_t key;      // String id of the key, if the node is a child of a map, IMAGE_NO_STRING otherwise
+            uint32_t value;    // String id of a scalar, position of the first child of a sequence or a map
+            uint32_t count;    // Number of children of a sequence or a map
+            int64_t i;         // Integer value of a scalar, offset into the numeric array section of a sequence
+            double f;          // Floating point value of a scalar
+        };
+        static_assert(sizeof(ImageNode) == 32, "compiled config image nodes are 32 bytes");
+
+        /// @brief String table entry of a compiled config image. Strings are interned, i.e. every distinct string is
+        /// stored once, irrespective of how often it occurs as key or value.
+        struct ImageString
+        {
+            uint64_t offset;   // Offset of the characters in the string characters section
+            uint32_t length;   // Number of characters
+            uint32_t reserved; // Reserved, zero
+        };
+
+        /// @brief Sorted key index entry of a compiled config image, which refers to a node by its combined key
+        struct ImageKey
+        {
+            uint32_t path; // String id of the combined key
+            uint32_t node; // Position of the node
+        };
+
+        /// @brief Read-only view of a compiled config image. The image memory is either mapped from a file or owned
+        /// as a buffer, and it is kept alive as long as the view exists.
+        class Image
+        {
+            std::shared_ptr<const void> _storage; // Keeps the image memory alive
+            char const *_base;                    // Start of the image
+            ImageHeader const *_header;           // Image header
+            ImageNode const *_nodes;              // Node table
+            ImageString const *_strings;          // String table
+            char const *_blob;                    // String characters
+            ImageKey const *_keys;                // Sorted key index
+            double const *_numbers;               // Contiguous numeric array section
+
+            /// @brief Constructor. Defined as private because images need to be validated before use.
+            Image(std::shared_ptr<const void> _storage, char const *_base);
+
+            /// @brief Validates the header and the bounds of all sections against the given image size, as well as
+            /// every reference between the sections, such that no accessor can read outside of the image
+            static bool validate(char const *_base, size_t _size);
+
+        public:
+            /// @brief Checks whether the file starts with the magic of a compiled config image
+            static bool Detect(std::filesystem::path const &_path);
+
+            /// @brief Maps a compiled config image file into memory read-only
+            /// @return image, nullptr if the file cannot be mapped or is not a valid image
+            static std::shared_ptr<const Image> Map(std::filesystem::path const &_path);
+
+            /// @brief Wraps a compiled config image mapped into memory, e.g. from a shared memory segment
+            /// @return image, nullptr if the mapping does not hold a valid image
+            static std::shared_ptr<const Image> FromMapping(std::shared_ptr<const MappedFile> _mapped);
+
+            /// @brief Wraps a compiled config image held by a buffer
+            /// @return image, nullptr if the buffer does not hold a valid image
+            static std::shared_ptr<const Image> FromBuffer(std::vector<char> &&_buffer);
+
+            /// @brief Root node of the image
+            inline ImageNode const &Root() const
+            {
+                return _nodes[0];
+            }
+
+            /// @brief Child of a sequence or a map node at the given position
+            inline ImageNode const &Child(ImageNode const &node, uint32_t idx) const
+            {
+                return _nodes[node.value + idx];
+            }
+
+            /// @brief Interned string against its id
+            inline std::string_view String(uint32_t id) const
+            {
+                return std::string_view(_blob + _strings[id].offset, _strings[id].length);
+            }
+
+            /// @brief Contiguous numeric values of a sequence node flagged with IMAGE_NUMERIC_SEQ
+            inline double const *Numbers(ImageNode const &node) const
+            {
+                return _numbers + node.i;
+            }
+
+            /// @brief Size of the image in bytes
+            inline size_t Size() const
+            {
+                return _header->size;
+            }
+
+            /// @brief Image header, which holds the layout of the sections
+            inline ImageHeader const &Header() const
+            {
+                return *_header;
+            }
+
+            /// @brief Looks up a node by its combined key using binary search over the sorted key index
+            /// @return node, nullptr if the key is not found
+            ImageNode const *Find(std::string_view key) const;
+
+            /// @brief Builds an equivalent yaml-cpp node tree for the subtree under the given node. Used to decode
+            /// config value types, for which no decoding directly from the image is implemented.
+            YAML::Node Materialize(ImageNode const &node) const;
+        };
+
+        /// @brief Compiles a node tree into a compiled config image
+        /// @param _root root node of the tree
+        /// @return image bytes
+        std::vector<char> CompileImage(YAML::Node const &_root);
+
+        struct NativeTree;
+
+        /// @brief Compiles a node tree parsed by the native parser into a compiled config image
+        /// @param _tree parsed node tree
+        /// @return image bytes
+        std::vector<char> CompileImage(NativeTree const &_tree);
+    } // namespace detail
+
+    /// @brief API to compile a YAML config file into a compiled config image file, which cfg::GetConfig_From loads
+    /// by mapping it into memory instead of parsing it. The image is written to a temporary file next to the output
+    /// and renamed into place.
+    /// @param _yaml_path path to the YAML config file
+    /// @param _image_path path to the compiled config image file
+    /// @return true if the image is written
+    bool CompileConfig(std::filesystem::path const &_yaml_path, std::filesystem::path const &_image_path);
+} // namespace cfg
+
+#endif // IMAGE_HPP
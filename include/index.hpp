@@ -0,0 +1,94 @@
+#ifndef INDEX_HPP
+#define INDEX_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+namespace cfg
+{
+    namespace detail
+    {
+        /// @brief 64 bit FNV-1a hash of a string. Defined as constexpr so that keys known at compile time can be
+        /// hashed at compile time.
+        constexpr uint64_t Hash(std::string_view str)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            for (char ch : str)
+            {
+                hash ^= static_cast<uint8_t>(ch);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        /// @brief Immutable, flattened index of a node tree. Every node, which can be reached through a chain of
+        /// map keys, is recorded against its combined key string (e.g. "road.color.saturation") in an
+        /// open-addressing hash table with linear probing. Hence, a lookup costs a single probe sequence,
+        /// irrespective of the depth of the key and the width of the maps along the way.
+        class FlatIndex
+        {
+            /// @brief Indexed node along with its combined key
+            struct Entry
+            {
+                uint64_t hash;   // Hash of the combined key
+                std::string key; // Combined key
+                YAML::Node node; // Indexed node
+            };
+
+            std::vector<Entry> _entries;  // Indexed nodes in the order of traversal
+            std::vector<uint32_t> _slots; // Hash table of one-based entry positions, zero denotes an empty slot
+            size_t _mask;                 // Hash table capacity minus one, capacity being a power of two
+
+            /// @brief Recursively records the children of a map node, using the combined key of the map node as
+            /// prefix. Duplicate keys retain the first occurrence, which is what a lookup in the tree would find.
+            void insert(YAML::Node const &node, std::string &_prefix, std::string const &_delimeter);
+
+            /// @brief Arranges the recorded entries into the hash table
+            void build();
+
+        public:
+            /// @brief Constructor. Flattens the node tree under the given root node.
+            /// @param _root root node of the tree
+            /// @param _delimeter separator for key segments
+            FlatIndex(YAML::Node const &_root, std::string const &_delimeter);
+
+            /// @brief Looks up a node against its combined key and the precomputed hash of the key
+            /// @return indexed node, nullptr if the key is not indexed
+            inline YAML::Node const *Find(std::string_view key, uint64_t hash) const
+            {
+                for (size_t pos = hash & _mask; _slots[pos] != 0; pos = (pos + 1) & _mask)
+                {
+                    Entry const &entry = _entries[_slots[pos] - 1];
+                    if (entry.hash == hash && entry.key == key)
+                    {
+                        return &entry.node;
+                    }
+                }
+                return nullptr;
+            }
+
+            /// @brief Looks up a node against its combined key
+            /// @return indexed node, nullptr if the key is not indexed
+            inline YAML::Node const *Find(std::string_view key) const
+            {
+                return Find(key, Hash(key));
+            }
+
+            /// @brief Number of indexed nodes
+            inline size_t Size() const
+            {
+                return _entries.size();
+            }
+
+            /// @brief Bytes taken by the entries, their combined keys and the hash table, not including the indexed
+            /// nodes, which are shared with the node tree
+            size_t Footprint() const;
+        };
+    } // namespace detail
+} // namespace cfg
+
+#endif // INDEX_HPP
@@ -0,0 +1,86 @@
+#ifndef LAZY_HPP
+#define LAZY_HPP
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <yaml-cpp/yaml.h>
+
+#include "mapped.hpp"
+
+namespace cfg
+{
+    namespace detail
+    {
+        /// @brief Config file, whose top-level sections are parsed on demand. The file is mapped into memory and
+        /// pre-scanned once for the byte ranges of its top-level keys, which is a lot cheaper than parsing it.
+        /// A section is parsed the first time it is looked up and kept for the lifetime of the document, while
+        /// sections, which are never looked up, cost neither parsing time nor memory for their node trees.
+        ///
+        /// The pre-scan accepts only files, which can be split into top-level sections without parsing them, i.e.
+        /// a block mapping with plain keys at column zero and without anchors or aliases, which could refer across
+        /// sections. Any other file is rejected and meant to be parsed eagerly. Should a section still turn out to
+        /// be inconsistent with the file, e.g. a multi-line scalar spanning sections, lookups fall back to parsing
+        /// the whole file. The file must not be modified in place while the document exists, it should rather be
+        /// replaced atomically, e.g. by renaming a temporary file.
+        class LazyDocument
+        {
+            /// @brief Top-level section of the file, which is parsed on first lookup
+            struct Entry
+            {
+                std::string key;                          // Top-level key of the section
+                size_t begin;                             // Offset of the first byte of the section
+                size_t end;                               // Offset past the last byte of the section
+                mutable std::once_flag parsed;            // Guards parsing of the section
+                mutable boost::optional<YAML::Node> node; // Value of the section, none if it is inconsistent
+                mutable bool consistent = false;          // Whether the section parsed into its key alone
+            };
+
+            std::shared_ptr<const MappedFile> _file;       // Mapped config file
+            std::vector<std::unique_ptr<Entry>> _sections; // Sections sorted by key, first occurrence of a key only
+            mutable std::once_flag _eager_parsed;          // Guards parsing of the whole file
+            mutable boost::optional<YAML::Node> _eager;    // Root node of the whole file, once parsed
+
+            /// @brief Constructor. Defined as private because documents are meant to be created using Scan.
+            explicit LazyDocument(std::shared_ptr<const MappedFile> _file)
+                : _file(std::move(_file)) {}
+
+            /// @brief Splits the mapped file into top-level sections
+            /// @return false if the file cannot be split without parsing it
+            bool scan();
+
+            /// @brief Parses the whole file, in case a section turns out to be inconsistent
+            boost::optional<YAML::Node> eager(std::string_view _key) const;
+
+        public:
+            /// @brief Maps and pre-scans a config file
+            /// @return document, nullptr if the file cannot be mapped or split into sections, in which case the
+            /// file is meant to be parsed eagerly
+            static std::shared_ptr<const LazyDocument> Scan(std::filesystem::path const &_path);
+
+            /// @brief Looks up the value of a top-level key, parsing its section on first lookup
+            /// @return value node, none if the key is missing or its section cannot be parsed
+            boost::optional<YAML::Node> Section(std::string_view _key) const;
+
+            /// @brief Top-level keys of all sections in the order of the file
+            std::vector<std::string_view> Keys() const;
+
+            /// @brief Number of top-level sections
+            inline size_t Size() const
+            {
+                return _sections.size();
+            }
+
+            /// @brief Bytes taken by the mapped file and the section table, not including the node trees of parsed
+            /// sections
+            size_t Footprint() const;
+        };
+    } // namespace detail
+} // namespace cfg
+
+#endif // LAZY_HPP
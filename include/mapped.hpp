@@ -0,0 +1,67 @@
+#ifndef MAPPED_HPP
+#define MAPPED_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace cfg
+{
+    namespace detail
+    {
+        /// @brief Hints the operating system to read a whole file ahead in the background, so that reading it
+        /// overlaps with whatever the caller does until it reads the file, e.g. parsing files read ahead earlier.
+        /// Does nothing on platforms without such hints.
+        /// @param _path path to the file
+        void Prefetch(std::filesystem::path const &_path);
+
+        /// @brief Read-only memory mapping of a whole file, which is unmapped on destruction. Pages are loaded on
+        /// first access and shared with other processes mapping the same file through the page cache.
+        class MappedFile
+        {
+            void *_addr;  // Start of the mapping
+            size_t _size; // Size of the mapping
+
+            /// @brief Constructor. Defined as private because mappings are meant to be created using Map.
+            MappedFile(void *_addr, size_t _size)
+                : _addr(_addr), _size(_size) {}
+
+            /// @brief Maps an open file descriptor read-only as a whole and closes it
+            static std::shared_ptr<const MappedFile> map(int _fd);
+
+        public:
+            MappedFile(MappedFile const &) = delete;
+            MappedFile &operator=(MappedFile const &) = delete;
+            ~MappedFile();
+
+            /// @brief Maps a file into memory read-only
+            /// @return mapping, nullptr if the file is empty or cannot be mapped, e.g. on platforms without mmap
+            static std::shared_ptr<const MappedFile> Map(std::filesystem::path const &_path);
+
+            /// @brief Maps a POSIX shared memory segment into memory read-only. The mapping remains valid after the
+            /// segment is unlinked.
+            /// @param _name segment name including the leading slash
+            /// @return mapping, nullptr if the segment does not exist, is empty or cannot be mapped
+            static std::shared_ptr<const MappedFile> MapSegment(std::string const &_name);
+
+            /// @brief Releases the pages of the mapping resident in this process. The pages are loaded again from
+            /// the page cache or the file, when they are accessed next.
+            void Evict() const;
+
+            /// @brief Start of the mapping
+            inline char const *Data() const
+            {
+                return static_cast<char const *>(_addr);
+            }
+
+            /// @brief Size of the mapping in bytes
+            inline size_t Size() const
+            {
+                return _size;
+            }
+        };
+    } // namespace detail
+} // namespace cfg
+
+#endif // MAPPED_HPP
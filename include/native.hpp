@@ -0,0 +1,57 @@
+#ifndef NATIVE_HPP
+#define NATIVE_HPP
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "image.hpp"
+
+namespace cfg
+{
+    namespace detail
+    {
+        constexpr uint32_t NATIVE_NONE = 0xFFFFFFFF;
+
+        /// @brief Node of a config file parsed by the native parser. Scalars and keys refer to the text of the file,
+        /// unless they contain escape sequences.
+        struct NativeNode
+        {
+            uint8_t type;            // Node type, see ImageNodeType
+            std::string_view key;    // Key, if the node is a value of a map
+            std::string_view scalar; // Value of a scalar
+            uint32_t first;          // Position of the first child of a sequence or a map, NATIVE_NONE if none
+            uint32_t last;           // Position of the last child of a sequence or a map, NATIVE_NONE if none
+            uint32_t next;           // Position of the next sibling, NATIVE_NONE if none
+        };
+
+        /// @brief Node tree of a config file parsed by the native parser. Nodes are allocated from a single array
+        /// and linked by their positions, the root node being the first one.
+        struct NativeTree
+        {
+            std::vector<NativeNode> nodes;   // Nodes in document order
+            std::deque<std::string> decoded; // Scalars and keys, which are unescaped, at stable addresses
+        };
+
+        /// @brief Parses a YAML document of the subset, which configs commonly use: block maps and sequences, flow
+        /// maps and sequences, plain, single- and double-quoted scalars, and comments. Anything beyond the subset,
+        /// e.g. anchors, aliases, tags, block scalars, multi-line scalars, complex keys or multiple documents, is
+        /// rejected along with malformed documents, so that the caller falls back to yaml-cpp.
+        /// @param _text document text
+        /// @param _tree parsed node tree
+        /// @return false if the document is not of the subset, in which case the tree is incomplete
+        bool ParseNative(std::string_view _text, NativeTree &_tree);
+
+        /// @brief Parses a config file of the subset using the native parser and compiles it into an in-memory
+        /// compiled config image, which yields the same config values as the node tree yaml-cpp would parse
+        /// @param _path path to the config file
+        /// @return image, nullptr if the file cannot be read, is empty or is not of the subset
+        std::shared_ptr<const Image> LoadNative(std::filesystem::path const &_path);
+    } // namespace detail
+} // namespace cfg
+
+#endif // NATIVE_HPP
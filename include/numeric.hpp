@@ -0,0 +1,123 @@
+#ifndef NUMERIC_HPP
+#define NUMERIC_HPP
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+namespace cfg
+{
+    namespace detail
+    {
+        /// @brief Whether config values of the type are numbers, which can be parsed using std::from_chars. Plain
+        /// char is excluded, because yaml-cpp decodes it as a single character rather than a number, and so is
+        /// bool, which yaml-cpp decodes from words like "true" or "yes".
+        template <typename T>
+        constexpr bool IsNumber = (std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>) ||
+                                  std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+        /// @brief Whether config values of the type are sequences of numbers
+        template <typename T>
+        constexpr bool IsNumberVector = false;
+
+        template <typename T, typename A>
+        constexpr bool IsNumberVector<std::vector<T, A>> = IsNumber<T>;
+
+        /// @brief Checks whether a scalar is spelled in the plain decimal notation, which std::from_chars parses
+        /// exactly like yaml-cpp's stream based conversion does. Anything else, e.g. octal or hexadecimal integers,
+        /// a leading plus sign or infinity, is left to yaml-cpp.
+        template <typename T>
+        constexpr bool isPlainDecimal(std::string_view text)
+        {
+            size_t pos = !text.empty() && text.front() == '-' ? 1 : 0;
+            if (pos == text.size())
+            {
+                return false;
+            }
+            if constexpr (std::is_integral_v<T>)
+            {
+                // Leading zeros denote octal integers for yaml-cpp
+                if (text[pos] == '0' && pos + 1 < text.size())
+                {
+                    return false;
+                }
+                for (; pos < text.size(); pos++)
+                {
+                    if (text[pos] < '0' || text[pos] > '9')
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            else
+            {
+                if ((text[pos] < '0' || text[pos] > '9') && text[pos] != '.')
+                {
+                    return false;
+                }
+                for (; pos < text.size(); pos++)
+                {
+                    const char ch = text[pos];
+                    if ((ch < '0' || ch > '9') && ch != '.' && ch != 'e' && ch != 'E' && ch != '-' && ch != '+')
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        }
+
+        /// @brief Parses a scalar into a number, yielding exactly what YAML::convert<T>::decode would. Scalars in
+        /// plain decimal notation are parsed using std::from_chars, which neither allocates nor constructs a
+        /// stream. Any other scalar, including the ones std::from_chars rejects, is handed over to yaml-cpp.
+        /// @return false if the scalar is not a number of the given type
+        template <typename T>
+        bool ParseNumber(std::string const &text, T &num)
+        {
+            if constexpr (IsNumber<T>)
+            {
+                if (isPlainDecimal<T>(text))
+                {
+                    T val{};
+                    const std::from_chars_result res = std::from_chars(text.data(), text.data() + text.size(), val);
+                    if (res.ec == std::errc() && res.ptr == text.data() + text.size())
+                    {
+                        num = val;
+                        return true;
+                    }
+                }
+            }
+            return YAML::convert<T>::decode(YAML::Node(text), num);
+        }
+
+        /// @brief Decodes a sequence of number scalars into a contiguous buffer
+        /// @return false if the node is not a sequence or any element is not a number of the given type
+        template <typename T>
+        bool DecodeNumbers(YAML::Node const &node, std::vector<T> &nums)
+        {
+            if (!node.IsSequence())
+            {
+                return false;
+            }
+            nums.clear();
+            nums.reserve(node.size());
+            for (auto const &item : node)
+            {
+                T num{};
+                if (!item.IsScalar() || !ParseNumber(item.Scalar(), num))
+                {
+                    return false;
+                }
+                nums.push_back(num);
+            }
+            return true;
+        }
+    } // namespace detail
+} // namespace cfg
+
+#endif // NUMERIC_HPP
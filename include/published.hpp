@@ -0,0 +1,121 @@
+#ifndef PUBLISHED_HPP
+#define PUBLISHED_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <boost/optional.hpp>
+
+#include "cfg.hpp"
+#include "mapped.hpp"
+#include "rcu.hpp"
+
+namespace cfg
+{
+    /// @brief Config attached read-only from a compiled config image, which another process published into POSIX
+    /// shared memory using cfg::PublishConfig. All processes attached to the same published config share the pages
+    /// of a single image instead of holding a node tree each, e.g. prefork workers of a server.
+    ///
+    /// Every publication carries a generation number, which is incremented with every publication under the same
+    /// name. cfg::PublishedConfig::Refresh compares the generation of the attached image with the published one
+    /// and attaches a newer image, if there is one. The check costs a single load from shared memory, hence it can
+    /// be made e.g. before every request a worker serves. An attached image is published to readers by swapping a
+    /// pointer like cfg::ReloadableConfig does, and it remains readable after a newer one is published, until the
+    /// last config referring to it is gone.
+    class PublishedConfig
+    {
+        std::string _name;                                  // Name of the published config
+        std::shared_ptr<const detail::MappedFile> _control; // Control segment holding the published generation
+        detail::RcuCell<ConfigBase> _cell;                  // Currently attached config
+        std::atomic<uint64_t> _generation;                  // Generation of the currently attached config
+        std::mutex _refresh_mutex;                          // Serializes refreshes
+
+        /// @brief Constructor. Defined as private to enforce cfg::GetPublishedConfig_From as api to instantiate
+        /// the published config.
+        PublishedConfig(std::string const &_name, std::shared_ptr<const detail::MappedFile> _control,
+                        uint64_t _generation, std::unique_ptr<const ConfigBase> _initial);
+
+        /// @brief Attaches the image of the currently published generation
+        /// @param _name name of the published config
+        /// @param _control control segment
+        /// @param _generation generation of the attached image
+        /// @return config, nullptr if no image is published
+        static std::unique_ptr<const ConfigBase> attach(std::string const &_name,
+                                                        detail::MappedFile const &_control, uint64_t &_generation);
+
+    public:
+        PublishedConfig() = delete;
+        PublishedConfig(PublishedConfig const &) = delete;
+        PublishedConfig &operator=(PublishedConfig const &) = delete;
+
+        /// @brief Accessor api for config values of the currently attached config. Never blocks, not even while
+        /// a newer image is being attached.
+        /// @tparam T configuration value type
+        /// @param key config key
+        /// @return optional config value
+        template <typename T>
+        boost::optional<T> Get(std::string const &key) const
+        {
+            return _cell.Read([&key](ConfigBase const &base)
+                              { return base.Get<T>(key); });
+        }
+
+        /// @brief Accessor api for config values of the currently attached config using a precompiled key
+        /// @tparam T configuration value type
+        /// @param key precompiled config key
+        /// @return optional config value
+        template <typename T>
+        boost::optional<T> Get(Key const &key) const
+        {
+            return _cell.Read([&key](ConfigBase const &base)
+                              { return base.Get<T>(key); });
+        }
+
+        /// @brief Currently attached config. The returned config remains unchanged, even if a newer image is
+        /// attached afterwards, which allows reading multiple values consistently from one generation.
+        ConfigBase Snapshot() const;
+
+        /// @brief Attaches the currently published image, if its generation is newer than the attached one
+        /// @return true if a newer image is attached, false if the attached image is current or the newer one
+        /// cannot be attached, in which case the attached image remains in use
+        bool Refresh();
+
+        /// @brief Generation of the currently attached image
+        inline uint64_t Generation() const
+        {
+            return _generation.load();
+        }
+
+        /// @brief Generation of the currently published image, which may be newer than the attached one
+        uint64_t PublishedGeneration() const;
+
+        /// @brief Specifies cfg::GetPublishedConfig_From as friend function to hide the main constructor
+        friend std::unique_ptr<PublishedConfig> GetPublishedConfig_From(std::string const &_name);
+    };
+
+    /// @brief Compiles a config file into a compiled config image and publishes it into POSIX shared memory under
+    /// the given name, as the next generation of the published config. Compiled config image files are published
+    /// as they are. The image of the previous generation is unlinked, while processes attached to it keep using it
+    /// until they refresh. Publications under the same name are serialized across processes.
+    /// @param _abs_path absolute path to the config file
+    /// @param _name name of the published config, without slashes or dots
+    /// @return true if the config is published, false if it cannot be loaded or published
+    bool PublishConfig(std::filesystem::path const &_abs_path, std::string const &_name);
+
+    /// @brief Unlinks a published config from shared memory. Processes attached to it keep using their images,
+    /// while it can no longer be attached or refreshed.
+    /// @param _name name of the published config
+    /// @return true if the config was published
+    bool UnpublishConfig(std::string const &_name);
+
+    /// @brief API to instantiate cfg::PublishedConfig, attaching the currently published image
+    /// @param _name name of the published config
+    /// @return published config, nullptr if no config is published under the name
+    std::unique_ptr<PublishedConfig> GetPublishedConfig_From(std::string const &_name);
+} // namespace cfg
+
+#endif // PUBLISHED_HPP
@@ -0,0 +1,109 @@
+#ifndef RCU_HPP
+#define RCU_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace cfg
+{
+    namespace detail
+    {
+        /// @brief Read-copy-update cell, which holds an immutable value that can be replaced at runtime. Readers
+        /// never take a lock. They announce themselves on a reader counter of the current epoch parity and load
+        /// the current value. A publisher swaps in the new value, flips the epoch and waits until the readers of the
+        /// previous epoch have left, before it reclaims the replaced value. Publishers are serialized among each
+        /// other, which keeps the waiting off the read path.
+        ///
+        /// A reader, which is preempted between loading the epoch and announcing itself, may announce itself on a
+        /// parity, which a publisher has already waited for. Hence readers check the epoch parity again after
+        /// announcing themselves and retry on the other parity if it has changed in the meantime. Once the parity is
+        /// confirmed, the next flip of the epoch waits for the reader, whichever value it loads.
+        /// @tparam T value type
+        template <typename T>
+        class RcuCell
+        {
+            static constexpr size_t STRIPES = 16; // Reader counters per epoch parity, to spread contention
+
+            /// @brief Reader counter padded to a cache line of its own
+            struct alignas(64) Counter
+            {
+                std::atomic<uint64_t> readers{0};
+            };
+
+            std::atomic<T const *> _current;      // Currently published value
+            std::atomic<uint64_t> _epoch;         // Incremented with every publication
+            mutable Counter _counters[2][STRIPES]; // Reader counters per epoch parity and stripe
+            std::mutex _publisher;                // Serializes publishers
+
+            /// @brief Stripe of the calling thread, assigned round-robin to threads on first use
+            static size_t stripe()
+            {
+                static std::atomic<size_t> next{0};
+                thread_local const size_t _stripe = next.fetch_add(1) % STRIPES;
+                return _stripe;
+            }
+
+        public:
+            /// @brief Constructor
+            /// @param value initial value
+            explicit RcuCell(std::unique_ptr<const T> value)
+                : _current(value.release()), _epoch(0) {}
+
+            RcuCell(RcuCell const &) = delete;
+            RcuCell &operator=(RcuCell const &) = delete;
+
+            ~RcuCell()
+            {
+                delete _current.load();
+            }
+
+            /// @brief Invokes the reader with the current value. The value remains valid for the duration of the
+            /// call, even if a new value is published in the meantime.
+            /// @param reader callable taking T const &
+            /// @return result of the reader
+            template <typename Reader>
+            auto Read(Reader &&reader) const -> decltype(reader(std::declval<T const &>()))
+            {
+                uint64_t parity = _epoch.load() & 1;
+                std::atomic<uint64_t> *announced = &_counters[parity][stripe()].readers;
+                announced->fetch_add(1);
+                while ((_epoch.load() & 1) != parity)
+                {
+                    announced->fetch_sub(1);
+                    parity ^= 1;
+                    announced = &_counters[parity][stripe()].readers;
+                    announced->fetch_add(1);
+                }
+                // Leaves the read section also when the reader throws
+                struct Leave
+                {
+                    std::atomic<uint64_t> &readers;
+                    ~Leave() { readers.fetch_sub(1); }
+                } leave{*announced};
+                return reader(*_current.load());
+            }
+
+            /// @brief Publishes a new value and reclaims the replaced one, once no reader can observe it anymore
+            /// @param value new value
+            void Publish(std::unique_ptr<const T> value)
+            {
+                std::lock_guard<std::mutex> lock(_publisher);
+                T const *replaced = _current.exchange(value.release());
+                const uint64_t parity = _epoch.fetch_add(1) & 1;
+                for (Counter const &counter : _counters[parity])
+                {
+                    while (counter.readers.load() != 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                delete replaced;
+            }
+        };
+    } // namespace detail
+} // namespace cfg
+
+#endif // RCU_HPP
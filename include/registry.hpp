@@ -0,0 +1,53 @@
+#ifndef REGISTRY_HPP
+#define REGISTRY_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+
+#include <boost/optional.hpp>
+
+namespace cfg
+{
+    class ConfigBase;
+    struct LoadOptions;
+
+    /// @brief Usage of the process-wide registry of shared configs, see cfg::SetSharedConfigCapacity
+    struct SharedConfigUsage
+    {
+        size_t entries = 0;    // Configs held by the registry
+        uint64_t bytes = 0;    // Memory footprint of the configs held by the registry
+        uint64_t capacity = 0; // Maximum memory footprint of the configs held by the registry, zero if disabled
+        uint64_t hits = 0;     // Loads served by a config, which is held or being parsed already
+        uint64_t loads = 0;    // Loads, which parsed the config file
+    };
+
+    /// @brief Enables the process-wide registry of shared configs. Once enabled, cfg::GetConfig_From parses every
+    /// config file only once and hands out copies of the same config to later callers, e.g. to all libraries of a
+    /// process reading the same file, as long as the file keeps its inode, size and modification time. Concurrent
+    /// loads of the same file wait for a single parse. Configs, which have not been loaded for the longest time, are
+    /// evicted from the registry once their memory footprint exceeds the capacity. Every config is charged with its
+    /// footprint right after loading, see cfg::ConfigBase::MemoryUsage, hence sections of a lazily parsed config,
+    /// which are parsed later on, are not charged. Evicted configs stay valid for as long as they are used. Files are
+    /// identified by their canonical path together with the load options.
+    /// @param bytes capacity in terms of the memory footprint of the configs, zero to disable the registry and evict
+    /// all configs, which is the default
+    void SetSharedConfigCapacity(uint64_t bytes);
+
+    /// @brief Usage of the process-wide registry of shared configs
+    SharedConfigUsage GetSharedConfigUsage();
+
+    namespace detail
+    {
+        /// @brief Looks a config up in the registry of shared configs, or loads and registers it unless the
+        /// registry is disabled
+        /// @param path path to the config file
+        /// @param options load options
+        /// @param load loads the config from the file, reporting any error
+        /// @return optional config, none if the file cannot be loaded
+        boost::optional<ConfigBase> Shared(std::filesystem::path const &path, LoadOptions const &options,
+                                           std::function<boost::optional<ConfigBase>()> const &load);
+    } // namespace detail
+} // namespace cfg
+
+#endif // REGISTRY_HPP
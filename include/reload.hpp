@@ -0,0 +1,129 @@
+#ifndef RELOAD_HPP
+#define RELOAD_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <boost/optional.hpp>
+
+#include "cfg.hpp"
+#include "rcu.hpp"
+
+namespace cfg
+{
+    /// @brief Callback of a subscription to changes of a cfg::ReloadableConfig. Called on the thread, which reloads
+    /// the config, after the new config is published. Must not throw.
+    using ConfigSubscriber = std::function<void(ConfigDiff const &diff, ConfigBase const &current)>;
+
+    /// @brief Config, which follows the changes of its file at runtime. The file is watched for changes (on Linux
+    /// using inotify) and every new version is parsed on a background thread, off the hot path. The parsed config
+    /// is published by swapping a pointer, hence readers never take a lock and never observe a partially built
+    /// config. A replaced config is reclaimed as soon as the last reader, which could observe it, is done.
+    ///
+    /// Files should be replaced atomically, e.g. by writing to a temporary file and renaming it, because a reload
+    /// triggered while the file is still being written could observe an incomplete file. If a new version of the
+    /// file cannot be loaded, the previous config remains published.
+    class ReloadableConfig
+    {
+        std::filesystem::path _path;       // Base path for config file
+        LoadOptions _options;              // Options for loading every version of the file
+        detail::RcuCell<ConfigBase> _cell; // Currently published config
+        std::atomic<uint64_t> _generation; // Number of successful reloads
+        std::thread _watcher;              // Watches the file for changes and reloads it
+        int _wake_fd;                      // Wakes the watcher up for shutdown, -1 if not watching
+        std::mutex _reload_mutex;          // Serializes reloads, so that subscribers observe consecutive versions
+        std::mutex _subscribers_mutex;     // Guards the subscribers
+        std::map<uint64_t, std::pair<std::string, ConfigSubscriber>> _subscribers; // Key prefixes and callbacks
+        uint64_t _next_subscription;       // Id of the next subscription
+
+        /// @brief Constructor. Defined as private to enforce cfg::GetReloadableConfig_From as api to instantiate
+        /// the reloadable config.
+        ReloadableConfig(std::filesystem::path const &_cfg_path, LoadOptions const &_options,
+                         std::unique_ptr<const ConfigBase> _initial);
+
+        /// @brief Starts watching the file for changes
+        void watch();
+
+        /// @brief Notifies the subscribers, whose key prefixes are affected by the changes between two versions
+        void notify(ConfigBase const &_previous, ConfigBase const &_current);
+
+    public:
+        ReloadableConfig() = delete;
+        ReloadableConfig(ReloadableConfig const &) = delete;
+        ReloadableConfig &operator=(ReloadableConfig const &) = delete;
+
+        /// @brief Destructor. Stops watching the file.
+        ~ReloadableConfig();
+
+        /// @brief Accessor api for config values of the currently published config. Never blocks, not even while
+        /// a new version of the config is being published.
+        /// @tparam T configuration value type
+        /// @param key config key
+        /// @return optional config value
+        template <typename T>
+        boost::optional<T> Get(std::string const &key) const
+        {
+            return _cell.Read([&key](ConfigBase const &base)
+                              { return base.Get<T>(key); });
+        }
+
+        /// @brief Accessor api for config values of the currently published config using a precompiled key
+        /// @tparam T configuration value type
+        /// @param key precompiled config key
+        /// @return optional config value
+        template <typename T>
+        boost::optional<T> Get(Key const &key) const
+        {
+            return _cell.Read([&key](ConfigBase const &base)
+                              { return base.Get<T>(key); });
+        }
+
+        /// @brief Currently published config. The returned config remains unchanged, even if the file is reloaded
+        /// afterwards, which allows reading multiple values consistently from one version of the file.
+        ConfigBase Snapshot() const;
+
+        /// @brief Loads the file and publishes the config synchronously, irrespective of any file change event
+        /// @return true if the file is loaded and published, false if the previous config remains published
+        bool Reload();
+
+        /// @brief Subscribes to changes of the config underneath a key prefix. Whenever a reloaded version of the
+        /// file differs from the previous one in any key, which equals the prefix, lies underneath it or contains
+        /// it, the callback is called with the difference and the new config. Other subscribers are not called,
+        /// hence a change of a single value refreshes only the components depending on it.
+        /// @param prefix combined key prefix, empty to subscribe to any change
+        /// @param subscriber callback
+        /// @return subscription id for cfg::ReloadableConfig::Unsubscribe
+        uint64_t Subscribe(std::string const &prefix, ConfigSubscriber subscriber);
+
+        /// @brief Cancels a subscription. A reload, which is in progress, may still call the callback once.
+        /// @param id subscription id
+        void Unsubscribe(uint64_t id);
+
+        /// @brief Number of successful reloads since instantiation
+        inline uint64_t Generation() const
+        {
+            return _generation.load();
+        }
+
+        /// @brief Specifies cfg::GetReloadableConfig_From as friend function to hide the main constructor
+        friend std::unique_ptr<ReloadableConfig> GetReloadableConfig_From(std::filesystem::path const &_abs_path,
+                                                                          LoadOptions const &_options);
+    };
+
+    /// @brief API to instantiate cfg::ReloadableConfig. Initialization fails if the file cannot be loaded initially.
+    /// @param _abs_path absolute path to the config file
+    /// @param _options options for loading every version of the file
+    /// @return reloadable config, nullptr if the file cannot be loaded
+    std::unique_ptr<ReloadableConfig> GetReloadableConfig_From(std::filesystem::path const &_abs_path,
+                                                               LoadOptions const &_options = LoadOptions());
+} // namespace cfg
+
+#endif // RELOAD_HPP
@@ -0,0 +1,106 @@
+#ifndef RESULT_HPP
+#define RESULT_HPP
+
+#include <string_view>
+#include <utility>
+
+#include <boost/optional.hpp>
+
+namespace cfg
+{
+    /// @brief Reasons, why a config value cannot be obtained
+    enum class Error
+    {
+        None,         // Config value is obtained
+        Missing,      // Key is not present in the config
+        Null,         // Value of the key is null
+        TypeMismatch, // Value of the key cannot be decoded to the value type
+        BadLength     // Value of the key is a sequence of another length than the fixed length value type
+    };
+
+    /// @brief Name of an error, e.g. for diagnostic messages
+    constexpr std::string_view ToString(Error error)
+    {
+        switch (error)
+        {
+        case Error::None:
+            return "none";
+        case Error::Missing:
+            return "missing";
+        case Error::Null:
+            return "null";
+        case Error::TypeMismatch:
+            return "type mismatch";
+        case Error::BadLength:
+            return "bad sequence length";
+        }
+        return "unknown";
+    }
+
+    /// @brief Outcome of looking up a config value using cfg::ConfigBase::TryGet, holding either the value or the
+    /// reason, why it cannot be obtained
+    /// @tparam T configuration value type
+    template <typename T>
+    class Result
+    {
+        boost::optional<T> _value; // Config value, none on failure
+        Error _error;              // Reason of the failure, Error::None on success
+
+    public:
+        /// @brief Constructs a successful result
+        Result(T const &value)
+            : _value(value), _error(Error::None) {}
+
+        /// @brief Constructs a successful result
+        Result(T &&value)
+            : _value(std::move(value)), _error(Error::None) {}
+
+        /// @brief Constructs a failed result
+        Result(Error error)
+            : _value(boost::none), _error(error) {}
+
+        /// @brief Whether the config value is obtained
+        bool has_value() const
+        {
+            return _value.has_value();
+        }
+
+        /// @brief Whether the config value is obtained
+        explicit operator bool() const
+        {
+            return has_value();
+        }
+
+        /// @brief Config value. Throws boost::bad_optional_access on failure.
+        T const &value() const
+        {
+            return _value.value();
+        }
+
+        /// @brief Config value, or the given fallback on failure
+        T value_or(T const &fallback) const
+        {
+            return _value.value_or(fallback);
+        }
+
+        /// @brief Reason of the failure, Error::None on success
+        Error error() const
+        {
+            return _error;
+        }
+
+        /// @brief Config value as optional, dropping the reason of a failure
+        boost::optional<T> const &optional() const &
+        {
+            return _value;
+        }
+
+        /// @brief Config value as optional, dropping the reason of a failure
+        boost::optional<T> &&optional() &&
+        {
+            return std::move(_value);
+        }
+    };
+} // namespace cfg
+
+#endif // RESULT_HPP
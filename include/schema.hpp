@@ -0,0 +1,133 @@
+#ifndef SCHEMA_HPP
+#define SCHEMA_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "index.hpp"
+
+namespace cfg
+{
+    /// @brief Outcome of binding a struct to a config using cfg::ConfigBase::Bind, listing the keys of all fields,
+    /// which could not be bound. Such fields retain the values they had before binding.
+    struct BindReport
+    {
+        std::vector<std::string> missing;  // Keys of fields, which are missing in the config
+        std::vector<std::string> mistyped; // Keys of fields, whose value is null or cannot be decoded to the field type
+
+        /// @brief Whether all fields are bound
+        inline bool Ok() const
+        {
+            return missing.empty() && mistyped.empty();
+        }
+    };
+
+    namespace detail
+    {
+        /// @brief Descriptor of a struct field, which is bound to a config key
+        /// @tparam S struct type
+        /// @tparam M field type
+        template <typename S, typename M>
+        struct Field
+        {
+            using Type = M;
+
+            std::string_view key; // Combined config key
+            uint64_t hash;        // Hash of the combined key, computed at compile time
+            M S::*member;         // Pointer to the bound member
+        };
+
+        /// @brief Makes the descriptor of a struct field, deducing the struct and field types from the member
+        template <typename S, typename M>
+        constexpr Field<S, M> MakeField(std::string_view key, M S::*member)
+        {
+            static_assert(std::is_default_constructible_v<M> && std::is_copy_assignable_v<M>,
+                          "config fields must be default constructible and copy assignable");
+            return Field<S, M>{key, Hash(key), member};
+        }
+
+        /// @brief Checks whether a combined key consists of non-empty, dot '.'-separated key segments
+        constexpr bool IsValidKey(std::string_view key)
+        {
+            if (key.empty() || key.front() == '.' || key.back() == '.')
+            {
+                return false;
+            }
+            for (size_t pos = 1; pos < key.size(); pos++)
+            {
+                if (key[pos] == '.' && key[pos - 1] == '.')
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// @brief Checks whether the keys of all fields of a schema are valid
+        template <typename... F>
+        constexpr bool HasValidKeys(std::tuple<F...> const &fields)
+        {
+            return std::apply([](auto const &...field)
+                              { return (IsValidKey(field.key) && ...); },
+                              fields);
+        }
+
+        /// @brief Checks whether no two fields of a schema are bound to the same key
+        template <typename... F>
+        constexpr bool HasUniqueKeys(std::tuple<F...> const &fields)
+        {
+            const std::array<std::string_view, sizeof...(F)> keys = std::apply(
+                [](auto const &...field)
+                { return std::array<std::string_view, sizeof...(F)>{field.key...}; },
+                fields);
+            for (size_t idx = 0; idx < keys.size(); idx++)
+            {
+                for (size_t other = idx + 1; other < keys.size(); other++)
+                {
+                    if (keys[idx] == keys[other])
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /// @brief Whether a config schema is declared for the type using CFG_SCHEMA
+        template <typename T, typename = void>
+        constexpr bool HasSchema = false;
+
+        template <typename T>
+        constexpr bool HasSchema<T, std::void_t<decltype(CfgSchema(static_cast<T const *>(nullptr)))>> = true;
+    } // namespace detail
+} // namespace cfg
+
+/// @brief Binds a field of the struct, whose schema is declared using CFG_SCHEMA, to a combined config key
+/// @param member name of the member
+/// @param key combined config key as string literal, e.g. "road.dims.length"
+#define CFG_FIELD(member, key) cfg::detail::MakeField(key, &Self::member)
+
+/// @brief Declares the config schema of a struct as a table of CFG_FIELD descriptors, which is evaluated at compile
+/// time. Malformed and duplicate keys fail to compile. Must be used at namespace scope of the namespace of the
+/// struct, e.g.
+///
+///     CFG_SCHEMA(Road, CFG_FIELD(length, "road.dims.length"), CFG_FIELD(width, "road.dims.width"))
+///
+/// @param Type struct type
+#define CFG_SCHEMA(Type, ...)                                                                                      \
+    constexpr auto CfgSchema(Type const *)                                                                         \
+    {                                                                                                              \
+        using Self = Type;                                                                                         \
+        return std::make_tuple(__VA_ARGS__);                                                                       \
+    }                                                                                                              \
+    static_assert(cfg::detail::HasValidKeys(CfgSchema(static_cast<Type const *>(nullptr))),                       \
+                  "config schema of " #Type " has empty or malformed keys");                                      \
+    static_assert(cfg::detail::HasUniqueKeys(CfgSchema(static_cast<Type const *>(nullptr))),                      \
+                  "config schema of " #Type " binds fields to duplicate keys")
+
+#endif // SCHEMA_HPP
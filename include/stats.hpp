@@ -0,0 +1,83 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "result.hpp"
+
+namespace cfg
+{
+    /// @brief Number of buckets of lookup latency histograms. Bucket i counts lookups taking less than 2^i ns and
+    /// at least 2^(i-1) ns, while the last bucket counts all slower lookups.
+    constexpr size_t LATENCY_BUCKETS = 32;
+
+    /// @brief Access statistics of a config key, or of all keys together
+    struct KeyStats
+    {
+        std::string key;                                 // Combined config key, empty for all keys together
+        uint64_t hits = 0;                               // Lookups, which obtained the value
+        uint64_t misses = 0;                             // Lookups of the key, which is missing
+        uint64_t failures = 0;                           // Lookups, whose value is null or cannot be decoded
+        uint64_t total_ns = 0;                           // Accumulated latency of timed lookups
+        std::array<uint64_t, LATENCY_BUCKETS> latency{}; // Timed lookups by latency, see LATENCY_BUCKETS
+
+        /// @brief Number of lookups
+        inline uint64_t Reads() const
+        {
+            return hits + misses + failures;
+        }
+
+        /// @brief Upper bound of the latency of the given fraction of timed lookups, e.g. 0.99 for the 99th
+        /// percentile, as read from the histogram
+        /// @return latency in ns, zero if no lookup is timed
+        uint64_t Percentile(double fraction) const;
+
+        /// @brief Adds the statistics of another key
+        void Merge(KeyStats const &other);
+    };
+
+    /// @brief Report of config accesses recorded by the instrumentation, see cfg::ConfigBase::AccessStats
+    struct AccessReport
+    {
+        bool enabled = false;            // Whether the library is built with CFG_WITH_INSTRUMENTATION
+        KeyStats total;                  // Statistics of all keys together
+        std::vector<KeyStats> hot;       // Most read keys, most read first
+        std::vector<std::string> unread; // Keys of the config, which are never read, in the order of the config
+
+        /// @brief Renders the report as JSON object
+        std::string ToJson() const;
+
+        /// @brief Renders the report as human-readable text
+        std::string ToText() const;
+    };
+
+    /// @brief Discards all access statistics recorded so far
+    void ResetAccessStats();
+
+    namespace detail
+    {
+        /// @brief Records a lookup of a key into the access statistics of the calling thread. Cheap enough for the
+        /// hot path, as every thread records into its own table, which is only merged when a report is requested.
+        /// Lookups are recorded per config, such that configs with the same keys do not count each other's reads.
+        /// @param config path of the config, which the key is looked up in
+        /// @param key combined config key
+        /// @param outcome outcome of the lookup
+        /// @param ns latency of the lookup
+        void Record(std::filesystem::path const &config, std::string_view key, Error outcome, uint64_t ns);
+
+        /// @brief Records a lookup of a key without timing it, e.g. as part of a batch
+        void Record(std::filesystem::path const &config, std::string_view key, Error outcome);
+
+        /// @brief Merges the access statistics of all threads for one config
+        /// @param config path of the config
+        /// @return statistics of all keys of the config read so far
+        std::vector<KeyStats> CollectAccessStats(std::filesystem::path const &config);
+    } // namespace detail
+} // namespace cfg
+
+#endif // STATS_HPP
@@ -2,55 +2,112 @@
 #define TYPES_HPP
 
 #include <assert.h>
+#include <algorithm>
+#include <array>
 #include <ostream>
+#include <string>
+#include <type_traits>
 #include <vector>
 #include <initializer_list>
 
 #include <yaml-cpp/yaml.h>
 
+#include "numeric.hpp"
+
 namespace cfg
 {
+    namespace detail
+    {
+        /// @brief Alignment of Vec<T, len>. Vectors of arithmetic values are aligned to the smallest power of two
+        /// covering their size, capped at 32 bytes, so that a vector can be loaded into a SIMD register at once and
+        /// arrays of vectors do not straddle such loads. Other vectors retain the alignment of their values.
+        template <typename T, size_t len>
+        constexpr size_t VecAlignment()
+        {
+            size_t alignment = alignof(T);
+            if constexpr (std::is_arithmetic_v<T>)
+            {
+                while (alignment < sizeof(T) * len && alignment < 32)
+                {
+                    alignment *= 2;
+                }
+            }
+            return alignment;
+        }
+    } // namespace detail
+
     /// @brief Universal variable length vector base type, which can be (de)serialized to and from YAML::Node.
-    /// Intended to be specialized according to need for defining config values.
+    /// Intended to be specialized according to need for defining config values. Values are stored inline, hence
+    /// vectors never allocate, and vectors of arithmetic values are trivially copyable.
     /// @tparam T Value type
     /// @tparam len Length
     template <typename T, size_t len>
-    struct Vec
+    struct alignas(detail::VecAlignment<T, len>()) Vec
     {
     protected:
-        std::vector<T> _buffer; // Internal container
+        std::array<T, len> _buffer; // Internal container
 
     public:
-        // @brief Main constructor
-        Vec(std::initializer_list<T> const &list)
+        /// @brief Default constructor, value-initializes all elements
+        constexpr Vec()
+            : _buffer{} {}
+
+        // @brief Main constructor. Elements beyond the given list are value-initialized.
+        constexpr Vec(std::initializer_list<T> const &list)
+            : _buffer{}
         {
-            _buffer.reserve(len);
-            _buffer = list;
+            assert(list.size() <= len);
+            for (size_t idx = 0; idx < len && idx < list.size(); idx++)
+            {
+                _buffer[idx] = list.begin()[idx];
+            }
         }
 
         /// @brief Convenient constructor for default initialization of derived types
         Vec(std::vector<T> const &vec)
+            : _buffer{}
         {
-            _buffer.reserve(len);
-            _buffer = vec;
+            assert(vec.size() <= len);
+            for (size_t idx = 0; idx < len && idx < vec.size(); idx++)
+            {
+                _buffer[idx] = vec[idx];
+            }
         }
 
         /// @brief Subscript operator overload as accessor
-        T operator[](size_t idx) const
+        constexpr T const &operator[](size_t idx) const
         {
-            assert(idx >= 0 && idx < len);
+            assert(idx < len);
             return _buffer[idx];
         }
 
         /// @brief Subscript operator overload as mutator
-        T &operator[](size_t idx)
+        constexpr T &operator[](size_t idx)
         {
-            assert(idx >= 0 && idx < len);
+            assert(idx < len);
             return _buffer[idx];
         }
 
+        /// @brief Contiguous storage of the elements
+        constexpr T const *data() const
+        {
+            return _buffer.data();
+        }
+
+        /// @brief Contiguous storage of the elements
+        constexpr T *data()
+        {
+            return _buffer.data();
+        }
+
+        /// @brief Number of elements
+        static constexpr size_t size()
+        {
+            return len;
+        }
+
         /// @brief Equality operator overload
-        bool operator==(Vec<T, len> const &other) const
+        constexpr bool operator==(Vec<T, len> const &other) const
         {
             for (size_t idx = 0; idx < len; idx++)
             {
@@ -63,36 +120,36 @@ namespace cfg
         }
 
         /// @brief Inequality operator overload
-        bool operator!=(Vec<T, len> const &other) const
+        constexpr bool operator!=(Vec<T, len> const &other) const
         {
-            return !this == other;
+            return !(*this == other);
         }
     };
 
-    /// @brief Specialization for integer vector of given length
+    /// @brief Specialization for double vector of given length
     template <size_t len>
     struct VecD : public Vec<double, len>
     {
         /// @brief Main constructor
-        VecD(std::initializer_list<double> const &list)
+        constexpr VecD(std::initializer_list<double> const &list)
             : Vec<double, len>(list) {}
 
         /// @brief Default constructor (required for deserialization)
-        VecD()
-            : Vec<double, len>(std::vector<double>(len)) {}
+        constexpr VecD()
+            : Vec<double, len>() {}
     };
 
-    /// @brief Specializes for double vector of given length
+    /// @brief Specialization for integer vector of given length
     template <size_t len>
     struct VecI : public Vec<int, len>
     {
         /// @brief Main constructor
-        VecI(std::initializer_list<int> const &list)
+        constexpr VecI(std::initializer_list<int> const &list)
             : Vec<int, len>(list) {}
 
         /// @brief Default constructor (required for deserialization)
-        VecI()
-            : Vec<int, len>(std::vector<int>(len)) {}
+        constexpr VecI()
+            : Vec<int, len>() {}
     };
 
     /// @brief Specialization for string vector of given length
@@ -105,7 +162,99 @@ namespace cfg
 
         /// @brief Default constructor (required for deserialization)
         VecStr()
-            : Vec<std::string, len>(std::vector<std::string>(len)) {}
+            : Vec<std::string, len>() {}
+    };
+
+    namespace detail
+    {
+        template <typename T, size_t len>
+        constexpr size_t vecLength(Vec<T, len> const *)
+        {
+            return len;
+        }
+
+        constexpr size_t vecLength(...)
+        {
+            return 0;
+        }
+
+        /// @brief Length of sequences, which decode to the config value type, i.e. the length of Vec<T, len> and
+        /// its specializations. Zero for any other type.
+        template <typename T>
+        constexpr size_t FixedLength = vecLength(static_cast<T const *>(nullptr));
+    } // namespace detail
+
+    /// @brief Two-dimensional table of numbers of arbitrary size, e.g. a calibration matrix or a lookup table.
+    /// Elements are stored contiguously in row-major order. A matrix is decoded from a sequence of equally long
+    /// sequences of numbers.
+    /// @tparam T Value type
+    template <typename T>
+    class Matrix
+    {
+        static_assert(std::is_arithmetic_v<T>, "matrix elements must be numbers");
+
+        size_t _rows;           // Number of rows
+        size_t _cols;           // Number of columns
+        std::vector<T> _buffer; // Elements in row-major order
+
+    public:
+        /// @brief Default constructor (required for deserialization)
+        Matrix()
+            : _rows(0), _cols(0) {}
+
+        /// @brief Constructs a matrix of the given size, value-initializing all elements
+        Matrix(size_t rows, size_t cols)
+            : _rows(rows), _cols(cols), _buffer(rows * cols) {}
+
+        /// @brief Accessor for the element at the given row and column
+        T const &operator()(size_t row, size_t col) const
+        {
+            assert(row < _rows && col < _cols);
+            return _buffer[row * _cols + col];
+        }
+
+        /// @brief Mutator for the element at the given row and column
+        T &operator()(size_t row, size_t col)
+        {
+            assert(row < _rows && col < _cols);
+            return _buffer[row * _cols + col];
+        }
+
+        /// @brief Contiguous storage of the elements in row-major order
+        T const *data() const
+        {
+            return _buffer.data();
+        }
+
+        /// @brief Contiguous storage of the elements in row-major order
+        T *data()
+        {
+            return _buffer.data();
+        }
+
+        /// @brief Number of rows
+        size_t rows() const
+        {
+            return _rows;
+        }
+
+        /// @brief Number of columns
+        size_t cols() const
+        {
+            return _cols;
+        }
+
+        /// @brief Equality operator overload
+        bool operator==(Matrix<T> const &other) const
+        {
+            return _rows == other._rows && _cols == other._cols && _buffer == other._buffer;
+        }
+
+        /// @brief Inequality operator overload
+        bool operator!=(Matrix<T> const &other) const
+        {
+            return !(*this == other);
+        }
     };
 
     /// Convenient type aliases for three-element vector types, commonly used to represent
@@ -113,6 +262,10 @@ namespace cfg
     using Vec3I = cfg::VecI<3>;
     using Vec3D = cfg::VecD<3>;
     using Vec3Str = cfg::VecStr<3>;
+
+    static_assert(std::is_trivially_copyable_v<Vec3D> && std::is_trivially_copyable_v<Vec3I>,
+                  "vectors of arithmetic values are trivially copyable");
+    static_assert(alignof(Vec3D) == 32 && alignof(Vec3I) == 16, "vectors of arithmetic values are SIMD aligned");
 } // namespace cfg
 
 namespace YAML
@@ -142,11 +295,37 @@ namespace YAML
             {
                 return false;
             }
-            if (len > 0)
+            if constexpr (cfg::detail::IsNumber<T>)
+            {
+                // Numbers are parsed without a stream per element, with the same result as YAML::Node::as<T>
+                size_t idx = 0;
+                for (auto const &item : node)
+                {
+                    if (!item.IsScalar() || !cfg::detail::ParseNumber(item.Scalar(), vec[idx++]))
+                    {
+                        return false;
+                    }
+                }
+            }
+            else if (len > 0)
             {
+                // Decodes the values directly instead of using YAML::Node::as<T>, which throws on failure
                 for (size_t idx = 0; idx < len; idx++)
                 {
-                    vec[idx] = node[idx].as<T>();
+                    const Node item = node[idx];
+                    if constexpr (std::is_same_v<T, std::string>)
+                    {
+                        // YAML::Node::as<std::string> spells null values out
+                        if (item.IsNull())
+                        {
+                            vec[idx] = "null";
+                            continue;
+                        }
+                    }
+                    if (!convert<T>::decode(item, vec[idx]))
+                    {
+                        return false;
+                    }
                 }
             }
             return true;
@@ -197,6 +376,52 @@ namespace YAML
             return convert<cfg::Vec<std::string, len>>::decode(node, vec);
         }
     };
+
+    /// @brief Implements (de)serialization of cfg::Matrix<T> to/from YAML::Node
+    template <typename T>
+    struct convert<cfg::Matrix<T>>
+    {
+        /// @brief Serializes cfg::Matrix<T> to YAML::Node as a sequence of rows
+        static Node encode(cfg::Matrix<T> const &mat)
+        {
+            Node node(NodeType::Sequence);
+            for (size_t row = 0; row < mat.rows(); row++)
+            {
+                Node seq(NodeType::Sequence);
+                for (size_t col = 0; col < mat.cols(); col++)
+                {
+                    seq.push_back(mat(row, col));
+                }
+                node.push_back(seq);
+            }
+            return node;
+        }
+
+        /// @brief Deserializes YAML::Node to cfg::Matrix<T>. Rows of different lengths are rejected.
+        static bool decode(Node const &node, cfg::Matrix<T> &mat)
+        {
+            if (!node.IsSequence())
+            {
+                return false;
+            }
+            const size_t rows = node.size();
+            const size_t cols = rows > 0 && node.begin()->IsSequence() ? node.begin()->size() : 0;
+            cfg::Matrix<T> buffer(rows, cols);
+            std::vector<T> values;
+            size_t row = 0;
+            for (auto const &item : node)
+            {
+                if (!cfg::detail::DecodeNumbers(item, values) || values.size() != cols)
+                {
+                    return false;
+                }
+                std::copy(values.begin(), values.end(), buffer.data() + row * cols);
+                row++;
+            }
+            mat = std::move(buffer);
+            return true;
+        }
+    };
 } // namespace YAML
 
 #endif // TYPES_HPP
\ No newline at end of file
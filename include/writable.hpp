@@ -0,0 +1,126 @@
+#ifndef WRITABLE_HPP
+#define WRITABLE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "cfg.hpp"
+#include "rcu.hpp"
+
+namespace cfg
+{
+    /// @brief Config, whose values can be changed at runtime and persisted to its file, e.g. by tooling tuning
+    /// parameters. Changes made with cfg::WritableConfig::Set are collected in a pending batch in memory, which
+    /// cfg::WritableConfig::Commit persists with a single write of a temporary file renamed over the config file,
+    /// hence any number of changes costs one file write, and the file is never observed partially written.
+    ///
+    /// A commit patches the text of the file where it can, i.e. only the changed values are replaced and new keys
+    /// are inserted into their maps, while all other text, including comments and formatting, is left as it is.
+    /// Every patched text is parsed and compared with the expected config before it is written. Changes, which
+    /// cannot be patched, e.g. values of block sequences or values spanning multiple lines, are persisted by
+    /// emitting the whole config instead, which loses comments. The committed config is published to readers by
+    /// swapping a pointer like cfg::ReloadableConfig does, hence readers are never blocked by a commit.
+    class WritableConfig
+    {
+        std::filesystem::path _path;                              // Base path for config file
+        LoadOptions _options;                                     // Options for loading every committed version
+        detail::RcuCell<ConfigBase> _cell;                        // Currently committed config
+        std::atomic<uint64_t> _generation;                        // Number of successful commits
+        std::mutex _write_mutex;                                  // Serializes changes and commits
+        std::vector<std::pair<std::string, YAML::Node>> _pending; // Pending changes in the order they are made
+
+        /// @brief Constructor. Defined as private to enforce cfg::GetWritableConfig_From as api to instantiate
+        /// the writable config.
+        WritableConfig(std::filesystem::path const &_cfg_path, LoadOptions const &_options,
+                       std::unique_ptr<const ConfigBase> _initial);
+
+        /// @brief Adds an encoded value to the pending changes
+        void set(std::string const &_key, YAML::Node &&_value);
+
+    public:
+        WritableConfig() = delete;
+        WritableConfig(WritableConfig const &) = delete;
+        WritableConfig &operator=(WritableConfig const &) = delete;
+
+        /// @brief Accessor api for config values of the currently committed config. Pending changes are not visible
+        /// until they are committed. Never blocks, not even while a commit is in progress.
+        /// @tparam T configuration value type
+        /// @param key config key
+        /// @return optional config value
+        template <typename T>
+        boost::optional<T> Get(std::string const &key) const
+        {
+            return _cell.Read([&key](ConfigBase const &base)
+                              { return base.Get<T>(key); });
+        }
+
+        /// @brief Accessor api for config values of the currently committed config using a precompiled key
+        /// @tparam T configuration value type
+        /// @param key precompiled config key
+        /// @return optional config value
+        template <typename T>
+        boost::optional<T> Get(Key const &key) const
+        {
+            return _cell.Read([&key](ConfigBase const &base)
+                              { return base.Get<T>(key); });
+        }
+
+        /// @brief Changes a config value in the pending batch. The value is encoded using its YAML::convert
+        /// specialization, e.g. the one of cfg::Vec<T, len>. Maps along a key, which does not exist yet, are
+        /// created when the change is committed.
+        /// @tparam T configuration value type
+        /// @param key dot '.'-separated config key
+        /// @param value config value
+        template <typename T>
+        void Set(std::string const &key, T const &value)
+        {
+            set(key, YAML::convert<T>::encode(value));
+        }
+
+        /// @brief Persists the pending changes to the config file and publishes the committed config. The changes
+        /// are applied on top of the current content of the file, in the order they are made. If the options ask
+        /// for the file to be loaded lazily, natively or compactly, and loading the written file fails, the failure
+        /// is reported, and the committed node tree is published instead, such that readers always observe what
+        /// the file holds.
+        /// @return true if the changes are persisted, or if there are none, false if the file cannot be read,
+        /// changed or written, in which case the changes remain pending and the file remains unchanged
+        bool Commit();
+
+        /// @brief Drops the pending changes
+        void Discard();
+
+        /// @brief Number of pending changes
+        size_t Pending();
+
+        /// @brief Currently committed config. The returned config remains unchanged, even if changes are committed
+        /// afterwards, which allows reading multiple values consistently from one version of the file.
+        ConfigBase Snapshot() const;
+
+        /// @brief Number of successful commits since instantiation
+        inline uint64_t Generation() const
+        {
+            return _generation.load();
+        }
+
+        /// @brief Specifies cfg::GetWritableConfig_From as friend function to hide the main constructor
+        friend std::unique_ptr<WritableConfig> GetWritableConfig_From(std::filesystem::path const &_abs_path,
+                                                                      LoadOptions const &_options);
+    };
+
+    /// @brief API to instantiate cfg::WritableConfig. Initialization fails if the file cannot be loaded initially.
+    /// @param _abs_path absolute path to the config file
+    /// @param _options options for loading every committed version of the file
+    /// @return writable config, nullptr if the file cannot be loaded
+    std::unique_ptr<WritableConfig> GetWritableConfig_From(std::filesystem::path const &_abs_path,
+                                                           LoadOptions const &_options = LoadOptions());
+} // namespace cfg
+
+#endif // WRITABLE_HPP
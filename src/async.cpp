@@ -0,0 +1,48 @@
+#include "cfg.hpp"
+#include "mapped.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+std::future<boost::optional<cfg::ConfigBase>> cfg::GetConfig_FromAsync(std::filesystem::path const &_abs_path,
+                                                                       cfg::LoadOptions const &_options)
+{
+    // Reading ahead starts right away, while the background thread is being started
+    cfg::detail::Prefetch(_abs_path);
+    return std::async(std::launch::async, [_abs_path, _options]()
+                      { return cfg::GetConfig_From(_abs_path, _options); });
+}
+
+std::vector<boost::optional<cfg::ConfigBase>> cfg::GetConfigs_From(
+    std::vector<std::filesystem::path> const &_abs_paths, cfg::LoadOptions const &_options)
+{
+    for (std::filesystem::path const &path : _abs_paths)
+    {
+        cfg::detail::Prefetch(path);
+    }
+    // Files are loaded by a pool of workers, each taking the next file in order, which has most likely been read
+    // ahead by then
+    std::vector<boost::optional<cfg::ConfigBase>> configs(_abs_paths.size());
+    std::atomic<size_t> next(0);
+    const auto load = [&]()
+    {
+        for (size_t idx = next.fetch_add(1); idx < _abs_paths.size(); idx = next.fetch_add(1))
+        {
+            configs[idx] = cfg::GetConfig_From(_abs_paths[idx], _options);
+        }
+    };
+    const size_t workers =
+        std::min<size_t>(_abs_paths.size(), std::max<size_t>(1, std::thread::hardware_concurrency()));
+    std::vector<std::thread> pool;
+    for (size_t idx = 1; idx < workers; idx++)
+    {
+        pool.emplace_back(load);
+    }
+    load();
+    for (std::thread &worker : pool)
+    {
+        worker.join();
+    }
+    return configs;
+}
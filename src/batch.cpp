@@ -0,0 +1,137 @@
+#include "cfg.hpp"
+
+#include <algorithm>
+
+void cfg::Batch::insert(std::string_view _key, uint32_t _slot)
+{
+    uint32_t trie = 0;
+    size_t start = 0;
+    while (true)
+    {
+        const size_t end = _key.find('.', start);
+        const std::string_view segment = _key.substr(start, end == std::string_view::npos ? end : end - start);
+        // Children are kept sorted by segment, so that a map key can be matched using binary search
+        std::vector<uint32_t> &children = _trie[trie].children;
+        auto it = std::lower_bound(children.begin(), children.end(), segment, [this](uint32_t child, std::string_view seg)
+                                   { return _trie[child].segment < seg; });
+        if (it == children.end() || _trie[*it].segment != segment)
+        {
+            const uint32_t child = static_cast<uint32_t>(_trie.size());
+            it = children.insert(it, child);
+            // Growing the trie invalidates references to its nodes
+            _trie.push_back(Trie{std::string(segment), {}, {}});
+        }
+        trie = *it;
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+        start = end + 1;
+    }
+    _trie[trie].slots.push_back(_slot);
+}
+
+void cfg::ConfigBase::walk(Batch const &_batch, uint32_t _trie, YAML::Node const &node, BatchResult &_result) const
+{
+    Batch::Trie const &trie = _batch._trie[_trie];
+    for (uint32_t slot : trie.slots)
+    {
+        _result._values[slot] = _batch._requests[slot].decode(detail::BatchNode{&node, nullptr, nullptr});
+        _result._found[slot] = true;
+    }
+    if (trie.children.empty() || !node.IsMap())
+    {
+        return;
+    }
+    // Scans the map once, matching every key against all trie children. Duplicate keys retain the first
+    // occurrence, which is what a lookup of a single key would find.
+    std::vector<bool> visited(trie.children.size(), false);
+    size_t remaining = trie.children.size();
+    for (auto it = node.begin(); it != node.end() && remaining > 0; ++it)
+    {
+        if (!it->first.IsScalar())
+        {
+            continue;
+        }
+        const std::string &key = it->first.Scalar();
+        auto child = std::lower_bound(trie.children.begin(), trie.children.end(), key,
+                                      [&_batch](uint32_t idx, std::string const &seg)
+                                      { return _batch._trie[idx].segment < seg; });
+        if (child == trie.children.end() || _batch._trie[*child].segment != key)
+        {
+            continue;
+        }
+        const size_t pos = static_cast<size_t>(child - trie.children.begin());
+        if (!visited[pos])
+        {
+            visited[pos] = true;
+            remaining--;
+            walk(_batch, *child, it->second, _result);
+        }
+    }
+}
+
+cfg::BatchResult cfg::ConfigBase::Get(cfg::Batch const &batch) const
+{
+    BatchResult result(batch._requests.size());
+    // Records the lookups of all keys into the access statistics, without timing them
+    const auto record = [this, &batch, &result]()
+    {
+#ifdef CFG_WITH_INSTRUMENTATION
+        for (size_t slot = 0; slot < batch._requests.size(); slot++)
+        {
+            detail::Record(_path, batch._requests[slot].key, result._values[slot]->error);
+        }
+#else
+        (void)batch;
+        (void)result;
+#endif
+    };
+    if (_snapshot->image || _snapshot->index)
+    {
+        // Compiled config images and flattened indexes look up every key in a single step anyway
+        for (size_t slot = 0; slot < batch._requests.size(); slot++)
+        {
+            Batch::Request const &request = batch._requests[slot];
+            detail::BatchNode node{nullptr, nullptr, nullptr};
+            if (_snapshot->image)
+            {
+                node.image = _snapshot->image.get();
+                node.image_node = _snapshot->image->Find(request.key);
+            }
+            else
+            {
+                node.node = _snapshot->index->Find(request.key, request.hash);
+            }
+            result._found[slot] = node.node != nullptr || node.image_node != nullptr;
+            result._values[slot] = request.decode(node);
+        }
+        record();
+        return result;
+    }
+    if (_snapshot->lazy)
+    {
+        for (uint32_t child : batch._trie.front().children)
+        {
+            boost::optional<YAML::Node> section = _snapshot->lazy->Section(batch._trie[child].segment);
+            if (section.has_value())
+            {
+                walk(batch, child, section.value(), result);
+            }
+        }
+    }
+    else
+    {
+        walk(batch, 0, _snapshot->root, result);
+    }
+    // Keys, which are not reached by the walk, are missing
+    for (size_t slot = 0; slot < batch._requests.size(); slot++)
+    {
+        if (!result._values[slot])
+        {
+            result._values[slot] = batch._requests[slot].decode(detail::BatchNode{nullptr, nullptr, nullptr});
+        }
+    }
+    record();
+    return result;
+}
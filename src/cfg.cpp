@@ -1,15 +1,148 @@
 #include "cfg.hpp"
 
+#include <algorithm>
+#include <functional>
+
 boost::optional<cfg::ConfigBase> cfg::GetConfig_From(std::filesystem::path const &_abs_path)
 {
-    try
+    return cfg::GetConfig_From(_abs_path, cfg::LoadOptions());
+}
+
+boost::optional<cfg::ConfigBase> cfg::GetConfig_From(std::filesystem::path const &_abs_path,
+                                                     cfg::LoadOptions const &_options)
+{
+    const auto load = [&]() -> boost::optional<cfg::ConfigBase>
     {
-        cfg::ConfigBase base = cfg::ConfigBase(_abs_path);
-        return base;
+        try
+        {
+            cfg::ConfigBase base = cfg::ConfigBase(_abs_path, _options);
+            return base;
+        }
+        catch (YAML::Exception const &e)
+        {
+            // Covers config files, which cannot be read (YAML::BadFile), as well as malformed ones
+            // (YAML::ParserException)
+            cfg::detail::Report(e.what());
+            return boost::none;
+        }
+    };
+    return cfg::detail::Shared(_abs_path, _options, load);
+}
+
+void cfg::ConfigBase::unread(std::unordered_set<std::string> const &_read,
+                             std::unordered_set<std::string> const &_touched, std::vector<std::string> &_keys) const
+{
+    const auto combine = [this](std::string const &prefix, std::string_view key)
+    { return prefix.empty() ? std::string(key) : prefix + _delimeter + std::string(key); };
+    if (_snapshot->image)
+    {
+        detail::Image const &image = *_snapshot->image;
+        const std::function<void(detail::ImageNode const &, std::string const &)> visit =
+            [&](detail::ImageNode const &node, std::string const &key)
+        {
+            if (_read.count(key) != 0)
+            {
+                return;
+            }
+            if (node.type != detail::IMAGE_MAP || node.count == 0)
+            {
+                _keys.push_back(key);
+                return;
+            }
+            for (uint32_t idx = 0; idx < node.count; idx++)
+            {
+                detail::ImageNode const &child = image.Child(node, idx);
+                visit(child, combine(key, image.String(child.key)));
+            }
+        };
+        for (uint32_t idx = 0; image.Root().type == detail::IMAGE_MAP && idx < image.Root().count; idx++)
+        {
+            detail::ImageNode const &child = image.Child(image.Root(), idx);
+            visit(child, std::string(image.String(child.key)));
+        }
+        return;
     }
-    catch (YAML::BadFile const &bf)
+    const std::function<void(YAML::Node const &, std::string const &)> visit =
+        [&](YAML::Node const &node, std::string const &key)
+    {
+        if (_read.count(key) != 0)
+        {
+            return;
+        }
+        if (!node.IsMap() || node.size() == 0)
+        {
+            _keys.push_back(key);
+            return;
+        }
+        for (auto const &kv : node)
+        {
+            if (kv.first.IsScalar())
+            {
+                visit(kv.second, combine(key, kv.first.Scalar()));
+            }
+        }
+    };
+    if (_snapshot->lazy)
+    {
+        // Sections, which have never been looked up, are not parsed for the sake of the report
+        for (std::string_view section : _snapshot->lazy->Keys())
+        {
+            const std::string key(section);
+            boost::optional<YAML::Node> node =
+                _touched.count(key) != 0 ? _snapshot->lazy->Section(section) : boost::none;
+            if (node.has_value())
+            {
+                visit(node.value(), key);
+            }
+            else if (_read.count(key) == 0)
+            {
+                _keys.push_back(key);
+            }
+        }
+        return;
+    }
+    if (_snapshot->root.IsMap())
+    {
+        for (auto const &kv : _snapshot->root)
+        {
+            if (kv.first.IsScalar())
+            {
+                visit(kv.second, kv.first.Scalar());
+            }
+        }
+    }
+}
+
+cfg::AccessReport cfg::ConfigBase::AccessStats(size_t top_n) const
+{
+    cfg::AccessReport report;
+#ifdef CFG_WITH_INSTRUMENTATION
+    report.enabled = true;
+    std::vector<cfg::KeyStats> stats = cfg::detail::CollectAccessStats(_path);
+    std::unordered_set<std::string> read;
+    std::unordered_set<std::string> touched;
+    for (cfg::KeyStats const &key_stats : stats)
     {
-        std::cerr << bf.what() << '\n';
-        return boost::none;
+        report.total.Merge(key_stats);
+        // Lookups of missing keys do not read any value of the config
+        if (key_stats.hits + key_stats.failures == 0)
+        {
+            continue;
+        }
+        read.insert(key_stats.key);
+        for (size_t pos = key_stats.key.find(_delimeter); pos != std::string::npos;
+             pos = key_stats.key.find(_delimeter, pos + 1))
+        {
+            touched.insert(key_stats.key.substr(0, pos));
+        }
     }
-}
\ No newline at end of file
+    std::sort(stats.begin(), stats.end(), [](cfg::KeyStats const &lhs, cfg::KeyStats const &rhs)
+              { return lhs.Reads() != rhs.Reads() ? lhs.Reads() > rhs.Reads() : lhs.key < rhs.key; });
+    stats.resize(std::min(stats.size(), top_n));
+    report.hot = std::move(stats);
+    unread(read, touched, report.unread);
+#else
+    (void)top_n;
+#endif
+    return report;
+}
@@ -0,0 +1,32 @@
+#include "diagnostics.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+
+namespace
+{
+    /// @brief Installed diagnostics sink. Swapped atomically, so that messages can be reported concurrently while
+    /// a new sink is installed.
+    std::shared_ptr<const cfg::Diagnostics> &sink()
+    {
+        static std::shared_ptr<const cfg::Diagnostics> _sink = std::make_shared<const cfg::Diagnostics>(
+            [](std::string_view message)
+            { std::cerr << message << '\n'; });
+        return _sink;
+    }
+} // namespace
+
+void cfg::SetDiagnostics(cfg::Diagnostics _sink)
+{
+    std::atomic_store(&sink(), std::make_shared<const cfg::Diagnostics>(std::move(_sink)));
+}
+
+void cfg::detail::Report(std::string_view message)
+{
+    const std::shared_ptr<const cfg::Diagnostics> _sink = std::atomic_load(&sink());
+    if (*_sink)
+    {
+        (*_sink)(message);
+    }
+}
@@ -0,0 +1,191 @@
+#include "cfg.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    /// @brief Node type tags, which keep values of different types apart, e.g. a null value and the string "~"
+    enum Tag : uint64_t
+    {
+        TAG_NULL = 1,
+        TAG_SCALAR,
+        TAG_SEQUENCE,
+        TAG_MAP
+    };
+
+    inline uint64_t mix(uint64_t hash, uint64_t value)
+    {
+        hash = (hash ^ value) * 0x9e3779b97f4a7c15ull;
+        return hash ^ (hash >> 32);
+    }
+
+    cfg::detail::HashTree build(YAML::Node const &node);
+
+    /// @brief Content hash of a node of any type
+    uint64_t hash(YAML::Node const &node)
+    {
+        switch (node.Type())
+        {
+        case YAML::NodeType::Scalar:
+            return mix(TAG_SCALAR, cfg::detail::Hash(node.Scalar()));
+        case YAML::NodeType::Sequence:
+        {
+            uint64_t seq = mix(TAG_SEQUENCE, node.size());
+            for (YAML::Node const &elem : node)
+            {
+                seq = mix(seq, hash(elem));
+            }
+            return seq;
+        }
+        case YAML::NodeType::Map:
+            return build(node).hash;
+        default:
+            return TAG_NULL;
+        }
+    }
+
+    /// @brief Hash tree of a map, or of any other node as leaf
+    cfg::detail::HashTree build(YAML::Node const &node)
+    {
+        cfg::detail::HashTree tree;
+        if (!node.IsMap())
+        {
+            tree.hash = hash(node);
+            return tree;
+        }
+        tree.map = true;
+        for (auto const &kv : node)
+        {
+            // Like lookups, only scalar keys are considered
+            if (kv.first.IsScalar())
+            {
+                tree.children.emplace_back(kv.first.Scalar(), build(kv.second));
+            }
+        }
+        // Duplicate keys retain the first occurrence, which is what a lookup would find
+        std::stable_sort(tree.children.begin(), tree.children.end(),
+                         [](auto const &lhs, auto const &rhs)
+                         { return lhs.first < rhs.first; });
+        tree.children.erase(std::unique(tree.children.begin(), tree.children.end(),
+                                        [](auto const &lhs, auto const &rhs)
+                                        { return lhs.first == rhs.first; }),
+                            tree.children.end());
+        tree.hash = mix(TAG_MAP, tree.children.size());
+        for (auto const &child : tree.children)
+        {
+            tree.hash = mix(mix(tree.hash, cfg::detail::Hash(child.first)), child.second.hash);
+        }
+        return tree;
+    }
+
+    /// @brief Whether a combined key lies underneath another one
+    bool under(std::string_view key, std::string_view prefix, std::string_view delimiter)
+    {
+        return key.size() > prefix.size() && key.compare(0, prefix.size(), prefix) == 0 &&
+               key.compare(prefix.size(), delimiter.size(), delimiter) == 0;
+    }
+} // namespace
+
+bool cfg::ConfigDiff::Touches(std::string_view prefix, std::string_view delimiter) const
+{
+    if (prefix.empty())
+    {
+        return !Empty();
+    }
+    for (std::vector<std::string> const *keys : {&added, &removed, &modified})
+    {
+        for (std::string const &key : *keys)
+        {
+            if (key == prefix || under(key, prefix, delimiter) || under(prefix, key, delimiter))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+cfg::detail::HashTree cfg::detail::HashTree::Build(YAML::Node const &root)
+{
+    if (!root.IsMap())
+    {
+        cfg::detail::HashTree tree;
+        tree.map = true;
+        tree.hash = mix(TAG_MAP, 0);
+        return tree;
+    }
+    return build(root);
+}
+
+void cfg::detail::Diff(cfg::detail::HashTree const &older, cfg::detail::HashTree const &newer,
+                       std::string const &key, std::string const &delimiter, cfg::ConfigDiff &diff)
+{
+    if (older.hash == newer.hash && older.map == newer.map)
+    {
+        return;
+    }
+    if (!older.map || !newer.map)
+    {
+        diff.modified.push_back(key);
+        return;
+    }
+    const auto combine = [&](std::string const &child)
+    { return key.empty() ? child : key + delimiter + child; };
+    // Children are sorted by key, hence both maps are compared in a single pass
+    auto old_it = older.children.begin();
+    auto new_it = newer.children.begin();
+    while (old_it != older.children.end() || new_it != newer.children.end())
+    {
+        if (new_it == newer.children.end() || (old_it != older.children.end() && old_it->first < new_it->first))
+        {
+            diff.removed.push_back(combine(old_it->first));
+            ++old_it;
+        }
+        else if (old_it == older.children.end() || new_it->first < old_it->first)
+        {
+            diff.added.push_back(combine(new_it->first));
+            ++new_it;
+        }
+        else
+        {
+            cfg::detail::Diff(old_it->second, new_it->second, combine(old_it->first), delimiter, diff);
+            ++old_it;
+            ++new_it;
+        }
+    }
+}
+
+cfg::detail::HashTree const &cfg::ConfigBase::hashTree() const
+{
+    return _snapshot->hashes.Get([this]()
+                                 {
+        if (_snapshot->image)
+        {
+            return detail::HashTree::Build(_snapshot->image->Materialize(_snapshot->image->Root()));
+        }
+        if (_snapshot->lazy)
+        {
+            // Sections, which cannot be parsed, cannot be read either
+            YAML::Node root(YAML::NodeType::Map);
+            for (std::string_view section : _snapshot->lazy->Keys())
+            {
+                boost::optional<YAML::Node> node = _snapshot->lazy->Section(section);
+                if (node.has_value())
+                {
+                    root.force_insert(std::string(section), node.value());
+                }
+            }
+            return detail::HashTree::Build(root);
+        }
+        return detail::HashTree::Build(_snapshot->root); });
+}
+
+cfg::ConfigDiff cfg::ConfigBase::Diff(cfg::ConfigBase const &_other) const
+{
+    cfg::ConfigDiff diff;
+    if (_snapshot != _other._snapshot)
+    {
+        cfg::detail::Diff(hashTree(), _other.hashTree(), "", _delimeter, diff);
+    }
+    return diff;
+}
@@ -0,0 +1,116 @@
+#include "cfg.hpp"
+
+bool cfg::ConfigValue::IsSequence() const
+{
+    return _node != nullptr ? _node->IsSequence() : _image_node->type == cfg::detail::IMAGE_SEQUENCE;
+}
+
+size_t cfg::ConfigBase::forEach(YAML::Node const &node, std::string &path, cfg::ConfigVisitor const &visitor) const
+{
+    // The root of a config holds no value itself, even if it is not a map
+    if (!path.empty() && (!node.IsMap() || node.size() == 0))
+    {
+        visitor(path, cfg::ConfigValue(node));
+        return 1;
+    }
+    if (!node.IsMap())
+    {
+        return 0;
+    }
+    size_t count = 0;
+    const size_t length = path.size();
+    for (auto const &kv : node)
+    {
+        if (!kv.first.IsScalar() || kv.first.Scalar().find(_delimeter) != std::string::npos)
+        {
+            continue;
+        }
+        if (length != 0)
+        {
+            path.append(_delimeter);
+        }
+        path.append(kv.first.Scalar());
+        count += forEach(kv.second, path, visitor);
+        path.resize(length);
+    }
+    return count;
+}
+
+size_t cfg::ConfigBase::forEach(cfg::detail::ImageNode const &node, std::string &path,
+                                cfg::ConfigVisitor const &visitor) const
+{
+    cfg::detail::Image const &image = *_snapshot->image;
+    if (!path.empty() && (node.type != cfg::detail::IMAGE_MAP || node.count == 0))
+    {
+        visitor(path, cfg::ConfigValue(image, node));
+        return 1;
+    }
+    if (node.type != cfg::detail::IMAGE_MAP)
+    {
+        return 0;
+    }
+    size_t count = 0;
+    const size_t length = path.size();
+    for (uint32_t idx = 0; idx < node.count; idx++)
+    {
+        cfg::detail::ImageNode const &child = image.Child(node, idx);
+        const std::string_view key = image.String(child.key);
+        if (key.find(_delimeter) != std::string_view::npos)
+        {
+            continue;
+        }
+        if (length != 0)
+        {
+            path.append(_delimeter);
+        }
+        path.append(key);
+        count += forEach(child, path, visitor);
+        path.resize(length);
+    }
+    return count;
+}
+
+size_t cfg::ConfigBase::ForEach(std::string const &prefix, cfg::ConfigVisitor const &visitor) const
+{
+    std::string path = prefix;
+    if (_snapshot->image)
+    {
+        cfg::detail::ImageNode const *node =
+            prefix.empty() ? &_snapshot->image->Root() : _snapshot->image->Find(prefix);
+        return node != nullptr ? forEach(*node, path, visitor) : 0;
+    }
+    if (_snapshot->index && !prefix.empty())
+    {
+        YAML::Node const *node = _snapshot->index->Find(prefix);
+        return node != nullptr ? forEach(*node, path, visitor) : 0;
+    }
+    if (_snapshot->lazy && prefix.empty())
+    {
+        // Sections, which cannot be parsed, cannot be looked up either
+        size_t count = 0;
+        for (std::string_view section : _snapshot->lazy->Keys())
+        {
+            boost::optional<YAML::Node> node = _snapshot->lazy->Section(section);
+            if (node.has_value() && section.find(_delimeter) == std::string_view::npos)
+            {
+                path.assign(section);
+                count += forEach(node.value(), path, visitor);
+            }
+        }
+        return count;
+    }
+    if (prefix.empty())
+    {
+        return forEach(_snapshot->root, path, visitor);
+    }
+    boost::optional<YAML::Node> node = _snapshot->lazy ? fetchLazy(prefix) : fetch(_snapshot->root, prefix, _delimeter);
+    return node.has_value() ? forEach(node.value(), path, visitor) : 0;
+}
+
+std::vector<std::string> cfg::ConfigBase::Keys(std::string const &prefix) const
+{
+    std::vector<std::string> keys;
+    ForEach(prefix, [&keys](std::string_view key, cfg::ConfigValue const &)
+            { keys.emplace_back(key); });
+    return keys;
+}
@@ -0,0 +1,572 @@
+#include "image.hpp"
+#include "diagnostics.hpp"
+#include "mapped.hpp"
+#include "native.hpp"
+#include "numeric.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <unordered_map>
+
+namespace
+{
+    /// @brief Rounds up to the alignment of image sections
+    inline uint64_t align8(uint64_t offset)
+    {
+        return (offset + 7) & ~uint64_t(7);
+    }
+
+    /// @brief Decodes a boolean exactly like YAML::convert<bool>, i.e. y, yes, true or on, or n, no, false or off,
+    /// spelled in lower case, upper case or capitalized, without constructing a node for the conversion
+    bool decodeBool(std::string_view text, bool &value)
+    {
+        static const std::string_view names[][2] = {{"y", "n"}, {"yes", "no"}, {"true", "false"}, {"on", "off"}};
+        if (text.empty() || text.size() > 5)
+        {
+            return false;
+        }
+        char lower[5];
+        bool all_lower = true;
+        bool rest_lower = true;
+        bool rest_upper = true;
+        for (size_t idx = 0; idx < text.size(); idx++)
+        {
+            const unsigned char c = static_cast<unsigned char>(text[idx]);
+            all_lower = all_lower && std::islower(c);
+            rest_lower = rest_lower && (idx == 0 || std::islower(c));
+            rest_upper = rest_upper && (idx == 0 || std::isupper(c));
+            lower[idx] = static_cast<char>(std::tolower(c));
+        }
+        if (!all_lower && !(std::isupper(static_cast<unsigned char>(text[0])) && (rest_lower || rest_upper)))
+        {
+            return false;
+        }
+        const std::string_view name(lower, text.size());
+        for (auto const &pair : names)
+        {
+            if (name == pair[0] || name == pair[1])
+            {
+                value = name == pair[0];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Decodes the typed values of a scalar, yielding exactly what the yaml-cpp conversions would
+    void decodeTyped(std::string_view text, cfg::detail::ImageNode &entry)
+    {
+        // Numbers start with a digit, a sign or a dot, e.g. ".inf", while yaml-cpp rejects anything else
+        if (!text.empty() && ((text[0] >= '0' && text[0] <= '9') || text[0] == '-' || text[0] == '+' || text[0] == '.'))
+        {
+            const std::string number(text);
+            int64_t i = 0;
+            double f = 0.;
+            if (cfg::detail::ParseNumber(number, i))
+            {
+                entry.flags |= cfg::detail::IMAGE_HAS_INT;
+                entry.i = i;
+            }
+            if (cfg::detail::ParseNumber(number, f))
+            {
+                entry.flags |= cfg::detail::IMAGE_HAS_FLOAT;
+                entry.f = f;
+            }
+        }
+        bool b = false;
+        if (decodeBool(text, b))
+        {
+            entry.flags |= cfg::detail::IMAGE_HAS_BOOL | (b ? cfg::detail::IMAGE_BOOL_VALUE : 0);
+        }
+    }
+
+    /// @brief Access to the nodes of a yaml-cpp node tree for building an image
+    struct YamlSource
+    {
+        using Node = YAML::Node;
+
+        uint8_t type(YAML::Node const &node) const
+        {
+            switch (node.Type())
+            {
+            case YAML::NodeType::Scalar:
+                return cfg::detail::IMAGE_SCALAR;
+            case YAML::NodeType::Sequence:
+                return cfg::detail::IMAGE_SEQUENCE;
+            case YAML::NodeType::Map:
+                return cfg::detail::IMAGE_MAP;
+            default:
+                return cfg::detail::IMAGE_NULL;
+            }
+        }
+
+        std::string_view scalar(YAML::Node const &node) const
+        {
+            return node.Scalar();
+        }
+
+        /// @brief Calls the function with every item of a sequence
+        template <typename F>
+        void items(YAML::Node const &node, F &&f) const
+        {
+            for (auto const &item : node)
+            {
+                f(YAML::Node(item));
+            }
+        }
+
+        /// @brief Calls the function with the key and value of every entry of a map. Children with non-scalar keys
+        /// are unreachable by key, hence skipped.
+        template <typename F>
+        void entries(YAML::Node const &node, F &&f) const
+        {
+            for (auto const &kv : node)
+            {
+                if (kv.first.IsScalar())
+                {
+                    f(std::string_view(kv.first.Scalar()), YAML::Node(kv.second));
+                }
+            }
+        }
+    };
+
+    /// @brief Access to the nodes of a node tree parsed by the native parser for building an image
+    struct NativeSource
+    {
+        using Node = uint32_t;
+
+        cfg::detail::NativeTree const &tree; // Parsed node tree
+
+        uint8_t type(uint32_t node) const
+        {
+            return tree.nodes[node].type;
+        }
+
+        std::string_view scalar(uint32_t node) const
+        {
+            return tree.nodes[node].scalar;
+        }
+
+        /// @brief Calls the function with every item of a sequence
+        template <typename F>
+        void items(uint32_t node, F &&f) const
+        {
+            for (uint32_t child = tree.nodes[node].first; child != cfg::detail::NATIVE_NONE;
+                 child = tree.nodes[child].next)
+            {
+                f(child);
+            }
+        }
+
+        /// @brief Calls the function with the key and value of every entry of a map
+        template <typename F>
+        void entries(uint32_t node, F &&f) const
+        {
+            for (uint32_t child = tree.nodes[node].first; child != cfg::detail::NATIVE_NONE;
+                 child = tree.nodes[child].next)
+            {
+                f(tree.nodes[child].key, child);
+            }
+        }
+    };
+
+    /// @brief Builds a compiled config image from a node tree. Nodes are laid out in breadth-first order, so that
+    /// the children of every sequence and map are contiguous.
+    /// @tparam Source access to the nodes of the tree, see YamlSource
+    template <typename Source>
+    class ImageBuilder
+    {
+        using Node = typename Source::Node;
+
+        /// @brief Node of the tree, which is yet to be laid out along with its children
+        struct Pending
+        {
+            Node node;        // Node of the tree
+            uint32_t pos;     // Position of the node in the image
+            std::string path; // Combined key of the node
+            bool indexed;     // Whether the node is reachable through a chain of map keys
+        };
+
+        Source const &_source;                                  // Access to the nodes of the tree
+        std::vector<cfg::detail::ImageNode> _nodes;             // Node table
+        std::vector<cfg::detail::ImageString> _strings;         // String table
+        std::string _blob;                                      // String characters
+        std::unordered_map<std::string, uint32_t> _interned;    // String ids by string
+        std::vector<uint32_t> _owners;                          // Map, which last used a string id as key, plus one
+        std::vector<cfg::detail::ImageKey> _keys;               // Key index, sorted once all nodes are laid out
+        std::vector<double> _numbers;                           // Contiguous numeric arrays
+        std::deque<Pending> _pending;                           // Nodes, whose children are yet to be laid out
+
+        /// @brief Adds a string to the string table and returns its id
+        uint32_t store(std::string_view str)
+        {
+            const uint32_t id = static_cast<uint32_t>(_strings.size());
+            _strings.push_back(cfg::detail::ImageString{_blob.size(), static_cast<uint32_t>(str.size()), 0});
+            _blob.append(str);
+            _owners.push_back(0);
+            return id;
+        }
+
+        /// @brief Interns a string and returns its id
+        uint32_t intern(std::string_view str)
+        {
+            std::string key(str);
+            auto it = _interned.find(key);
+            if (it != _interned.end())
+            {
+                return it->second;
+            }
+            const uint32_t id = store(str);
+            _interned.emplace(std::move(key), id);
+            return id;
+        }
+
+        /// @brief Appends a node to the node table, decoding typed values of scalars
+        void append(Node const &node, uint32_t key)
+        {
+            cfg::detail::ImageNode entry{};
+            entry.key = key;
+            entry.value = cfg::detail::IMAGE_NO_STRING;
+            entry.type = _source.type(node);
+            if (entry.type == cfg::detail::IMAGE_SCALAR)
+            {
+                const std::string_view scalar = _source.scalar(node);
+                entry.value = intern(scalar);
+                decodeTyped(scalar, entry);
+            }
+            _nodes.push_back(entry);
+        }
+
+        /// @brief Lays out the children of a pending node
+        void expand(Pending const &pending)
+        {
+            const uint32_t first = static_cast<uint32_t>(_nodes.size());
+            if (_nodes[pending.pos].type == cfg::detail::IMAGE_SEQUENCE)
+            {
+                std::vector<double> numbers;
+                _source.items(pending.node, [&](Node const &item)
+                              {
+                    append(item, cfg::detail::IMAGE_NO_STRING);
+                    if (_nodes.back().flags & cfg::detail::IMAGE_HAS_FLOAT)
+                    {
+                        numbers.push_back(_nodes.back().f);
+                    }
+                    _pending.push_back(
+                        Pending{item, static_cast<uint32_t>(_nodes.size() - 1), std::string(), false}); });
+                cfg::detail::ImageNode &entry = _nodes[pending.pos];
+                entry.value = first;
+                entry.count = static_cast<uint32_t>(_nodes.size()) - first;
+                if (entry.count > 0 && numbers.size() == entry.count)
+                {
+                    entry.flags |= cfg::detail::IMAGE_NUMERIC_SEQ;
+                    entry.i = static_cast<int64_t>(_numbers.size());
+                    _numbers.insert(_numbers.end(), numbers.begin(), numbers.end());
+                }
+            }
+            else if (_nodes[pending.pos].type == cfg::detail::IMAGE_MAP)
+            {
+                _source.entries(pending.node, [&](std::string_view key, Node const &value)
+                                {
+                    // Duplicate keys retain the first occurrence, which is what a lookup in the tree would find
+                    const uint32_t id = intern(key);
+                    if (_owners[id] == pending.pos + 1)
+                    {
+                        return;
+                    }
+                    _owners[id] = pending.pos + 1;
+                    append(value, id);
+                    const uint32_t pos = static_cast<uint32_t>(_nodes.size() - 1);
+                    // Keys containing the delimiter cannot be reached by a combined key
+                    const bool indexed = pending.indexed && key.find('.') == std::string_view::npos;
+                    std::string path = pending.path.empty() ? std::string(key) : pending.path + "." + std::string(key);
+                    if (indexed)
+                    {
+                        // Combined keys are unique, since duplicate keys are skipped, hence not interned
+                        _keys.push_back(cfg::detail::ImageKey{store(path), pos});
+                    }
+                    _pending.push_back(Pending{value, pos, std::move(path), indexed}); });
+                cfg::detail::ImageNode &entry = _nodes[pending.pos];
+                entry.value = first;
+                entry.count = static_cast<uint32_t>(_nodes.size()) - first;
+            }
+        }
+
+    public:
+        /// @brief Lays out the whole tree under the given root node
+        ImageBuilder(Source const &_source, Node const &_root)
+            : _source(_source)
+        {
+            append(_root, cfg::detail::IMAGE_NO_STRING);
+            _pending.push_back(Pending{_root, 0, std::string(), true});
+            while (!_pending.empty())
+            {
+                expand(_pending.front());
+                _pending.pop_front();
+            }
+            auto path = [this](cfg::detail::ImageKey const &key)
+            {
+                return std::string_view(_blob).substr(_strings[key.path].offset, _strings[key.path].length);
+            };
+            std::sort(_keys.begin(), _keys.end(),
+                      [&path](cfg::detail::ImageKey const &lhs, cfg::detail::ImageKey const &rhs)
+                      { return path(lhs) < path(rhs); });
+        }
+
+        /// @brief Serializes the image
+        std::vector<char> Serialize() const
+        {
+            cfg::detail::ImageHeader header{};
+            std::memcpy(header.magic, cfg::detail::IMAGE_MAGIC, sizeof(header.magic));
+            header.version = cfg::detail::IMAGE_VERSION;
+            header.endian = cfg::detail::IMAGE_ENDIAN;
+            header.node_count = static_cast<uint32_t>(_nodes.size());
+            header.string_count = static_cast<uint32_t>(_strings.size());
+            header.key_count = static_cast<uint32_t>(_keys.size());
+            header.number_count = _numbers.size();
+            header.nodes_offset = align8(sizeof(header));
+            header.strings_offset = align8(header.nodes_offset + _nodes.size() * sizeof(cfg::detail::ImageNode));
+            header.blob_offset = align8(header.strings_offset + _strings.size() * sizeof(cfg::detail::ImageString));
+            header.blob_size = _blob.size();
+            header.keys_offset = align8(header.blob_offset + _blob.size());
+            header.numbers_offset = align8(header.keys_offset + _keys.size() * sizeof(cfg::detail::ImageKey));
+            header.size = header.numbers_offset + _numbers.size() * sizeof(double);
+
+            std::vector<char> buffer(header.size, 0);
+            std::memcpy(buffer.data(), &header, sizeof(header));
+            std::memcpy(buffer.data() + header.nodes_offset, _nodes.data(),
+                        _nodes.size() * sizeof(cfg::detail::ImageNode));
+            std::memcpy(buffer.data() + header.strings_offset, _strings.data(),
+                        _strings.size() * sizeof(cfg::detail::ImageString));
+            std::memcpy(buffer.data() + header.blob_offset, _blob.data(), _blob.size());
+            std::memcpy(buffer.data() + header.keys_offset, _keys.data(), _keys.size() * sizeof(cfg::detail::ImageKey));
+            std::memcpy(buffer.data() + header.numbers_offset, _numbers.data(), _numbers.size() * sizeof(double));
+            return buffer;
+        }
+    };
+} // namespace
+
+cfg::detail::Image::Image(std::shared_ptr<const void> _storage, char const *_base)
+    : _storage(std::move(_storage)), _base(_base)
+{
+    _header = reinterpret_cast<ImageHeader const *>(_base);
+    _nodes = reinterpret_cast<ImageNode const *>(_base + _header->nodes_offset);
+    _strings = reinterpret_cast<ImageString const *>(_base + _header->strings_offset);
+    _blob = _base + _header->blob_offset;
+    _keys = reinterpret_cast<ImageKey const *>(_base + _header->keys_offset);
+    _numbers = reinterpret_cast<double const *>(_base + _header->numbers_offset);
+}
+
+bool cfg::detail::Image::validate(char const *_base, size_t _size)
+{
+    if (_size < sizeof(ImageHeader))
+    {
+        return false;
+    }
+    ImageHeader const &header = *reinterpret_cast<ImageHeader const *>(_base);
+    if (std::memcmp(header.magic, IMAGE_MAGIC, sizeof(header.magic)) != 0 || header.version != IMAGE_VERSION ||
+        header.endian != IMAGE_ENDIAN || header.size != _size || header.node_count == 0)
+    {
+        return false;
+    }
+    // Every section must be aligned and lie within the image
+    auto within = [&](uint64_t offset, uint64_t count, uint64_t width)
+    {
+        return offset % 8 == 0 && offset <= _size && count <= (_size - offset) / width;
+    };
+    if (!within(header.nodes_offset, header.node_count, sizeof(ImageNode)) ||
+        !within(header.strings_offset, header.string_count, sizeof(ImageString)) ||
+        !within(header.blob_offset, header.blob_size, 1) ||
+        !within(header.keys_offset, header.key_count, sizeof(ImageKey)) ||
+        !within(header.numbers_offset, header.number_count, sizeof(double)))
+    {
+        return false;
+    }
+    // Every reference between the sections must lie within its target section, since accessors index unchecked
+    ImageString const *strings = reinterpret_cast<ImageString const *>(_base + header.strings_offset);
+    for (uint64_t id = 0; id < header.string_count; id++)
+    {
+        if (strings[id].offset > header.blob_size || strings[id].length > header.blob_size - strings[id].offset)
+        {
+            return false;
+        }
+    }
+    auto string = [&](uint32_t id)
+    {
+        return id < header.string_count;
+    };
+    ImageKey const *keys = reinterpret_cast<ImageKey const *>(_base + header.keys_offset);
+    for (uint64_t idx = 0; idx < header.key_count; idx++)
+    {
+        if (!string(keys[idx].path) || keys[idx].node >= header.node_count)
+        {
+            return false;
+        }
+    }
+    // Children are laid out breadth first, i.e. the children of every container follow the children of the
+    // containers before it, and they come after their parent, which rules out cycles and shared children
+    ImageNode const *nodes = reinterpret_cast<ImageNode const *>(_base + header.nodes_offset);
+    uint64_t next = 1;
+    for (uint64_t idx = 0; idx < header.node_count; idx++)
+    {
+        ImageNode const &node = nodes[idx];
+        if (node.type > IMAGE_MAP || (node.key != IMAGE_NO_STRING && !string(node.key)))
+        {
+            return false;
+        }
+        if (node.type == IMAGE_SCALAR && !string(node.value))
+        {
+            return false;
+        }
+        if ((node.type == IMAGE_SEQUENCE || node.type == IMAGE_MAP) && node.count > 0)
+        {
+            if (node.value != next || node.value <= idx || node.count > header.node_count - node.value)
+            {
+                return false;
+            }
+            next += node.count;
+            for (uint32_t child = 0; node.type == IMAGE_MAP && child < node.count; child++)
+            {
+                if (nodes[node.value + child].key == IMAGE_NO_STRING)
+                {
+                    return false;
+                }
+            }
+        }
+        if ((node.flags & IMAGE_NUMERIC_SEQ) &&
+            (node.i < 0 || uint64_t(node.i) > header.number_count || node.count > header.number_count - node.i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool cfg::detail::Image::Detect(std::filesystem::path const &_path)
+{
+    char magic[sizeof(IMAGE_MAGIC)] = {};
+    std::ifstream in(_path, std::ios::binary);
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, IMAGE_MAGIC, sizeof(magic)) == 0;
+}
+
+std::shared_ptr<const cfg::detail::Image> cfg::detail::Image::Map(std::filesystem::path const &_path)
+{
+    std::shared_ptr<const MappedFile> mapped = MappedFile::Map(_path);
+    if (!mapped)
+    {
+        // Platforms without mmap read the image into a buffer instead
+        std::ifstream in(_path, std::ios::binary);
+        std::vector<char> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        return FromBuffer(std::move(buffer));
+    }
+    return FromMapping(std::move(mapped));
+}
+
+std::shared_ptr<const cfg::detail::Image> cfg::detail::Image::FromMapping(std::shared_ptr<const MappedFile> _mapped)
+{
+    if (!_mapped || !validate(_mapped->Data(), _mapped->Size()))
+    {
+        return nullptr;
+    }
+    char const *base = _mapped->Data();
+    return std::shared_ptr<const Image>(new Image(std::move(_mapped), base));
+}
+
+std::shared_ptr<const cfg::detail::Image> cfg::detail::Image::FromBuffer(std::vector<char> &&_buffer)
+{
+    auto storage = std::make_shared<const std::vector<char>>(std::move(_buffer));
+    if (!validate(storage->data(), storage->size()))
+    {
+        return nullptr;
+    }
+    char const *base = storage->data();
+    return std::shared_ptr<const Image>(new Image(std::move(storage), base));
+}
+
+cfg::detail::ImageNode const *cfg::detail::Image::Find(std::string_view key) const
+{
+    ImageKey const *first = _keys;
+    ImageKey const *last = _keys + _header->key_count;
+    ImageKey const *it = std::lower_bound(first, last, key, [this](ImageKey const &entry, std::string_view _key)
+                                          { return String(entry.path) < _key; });
+    if (it == last || String(it->path) != key)
+    {
+        return nullptr;
+    }
+    return &_nodes[it->node];
+}
+
+YAML::Node cfg::detail::Image::Materialize(ImageNode const &node) const
+{
+    switch (node.type)
+    {
+    case IMAGE_SCALAR:
+        return YAML::Node(std::string(String(node.value)));
+    case IMAGE_SEQUENCE:
+    {
+        YAML::Node seq(YAML::NodeType::Sequence);
+        for (uint32_t idx = 0; idx < node.count; idx++)
+        {
+            seq.push_back(Materialize(Child(node, idx)));
+        }
+        return seq;
+    }
+    case IMAGE_MAP:
+    {
+        YAML::Node map(YAML::NodeType::Map);
+        for (uint32_t idx = 0; idx < node.count; idx++)
+        {
+            ImageNode const &child = Child(node, idx);
+            map.force_insert(std::string(String(child.key)), Materialize(child));
+        }
+        return map;
+    }
+    default:
+        return YAML::Node(YAML::NodeType::Null);
+    }
+}
+
+std::vector<char> cfg::detail::CompileImage(YAML::Node const &_root)
+{
+    const YamlSource source;
+    return ImageBuilder<YamlSource>(source, _root).Serialize();
+}
+
+std::vector<char> cfg::detail::CompileImage(cfg::detail::NativeTree const &_tree)
+{
+    const NativeSource source{_tree};
+    return ImageBuilder<NativeSource>(source, 0).Serialize();
+}
+
+bool cfg::CompileConfig(std::filesystem::path const &_yaml_path, std::filesystem::path const &_image_path)
+{
+    std::vector<char> image;
+    try
+    {
+        image = cfg::detail::CompileImage(YAML::LoadFile(_yaml_path));
+    }
+    catch (YAML::Exception const &e)
+    {
+        cfg::detail::Report(e.what());
+        return false;
+    }
+    const std::filesystem::path tmp_path = _image_path.string() + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out.write(image.data(), static_cast<std::streamsize>(image.size())))
+        {
+            cfg::detail::Report("Failed to write " + tmp_path.string());
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, _image_path, ec);
+    if (ec)
+    {
+        cfg::detail::Report("Failed to write " + _image_path.string() + ": " + ec.message());
+        return false;
+    }
+    return true;
+}
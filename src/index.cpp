@@ -0,0 +1,83 @@
+#include "index.hpp"
+
+cfg::detail::FlatIndex::FlatIndex(YAML::Node const &_root, std::string const &_delimeter)
+    : _mask(0)
+{
+    std::string _prefix;
+    insert(_root, _prefix, _delimeter);
+    build();
+}
+
+void cfg::detail::FlatIndex::insert(YAML::Node const &node, std::string &_prefix, std::string const &_delimeter)
+{
+    if (!node.IsMap())
+    {
+        return;
+    }
+    const size_t _prefix_len = _prefix.size();
+    for (auto const &kv : node)
+    {
+        // Keys containing the delimiter cannot be reached by a tree walk, hence they are not indexed either
+        if (!kv.first.IsScalar() || kv.first.Scalar().find(_delimeter) != std::string::npos)
+        {
+            continue;
+        }
+        if (_prefix_len > 0)
+        {
+            _prefix.append(_delimeter);
+        }
+        _prefix.append(kv.first.Scalar());
+        _entries.push_back(Entry{Hash(_prefix), _prefix, kv.second});
+        insert(kv.second, _prefix, _delimeter);
+        _prefix.resize(_prefix_len);
+    }
+}
+
+void cfg::detail::FlatIndex::build()
+{
+    // Keep the load factor at or below one half to keep probe sequences short
+    size_t capacity = 2;
+    while (capacity < _entries.size() * 2)
+    {
+        capacity *= 2;
+    }
+    _slots.assign(capacity, 0);
+    _mask = capacity - 1;
+    std::vector<Entry> _unique;
+    _unique.reserve(_entries.size());
+    for (Entry const &entry : _entries)
+    {
+        size_t pos = entry.hash & _mask;
+        bool duplicate = false;
+        for (; _slots[pos] != 0; pos = (pos + 1) & _mask)
+        {
+            Entry const &other = _unique[_slots[pos] - 1];
+            if (other.hash == entry.hash && other.key == entry.key)
+            {
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate)
+        {
+            _unique.push_back(entry);
+            _slots[pos] = static_cast<uint32_t>(_unique.size());
+        }
+    }
+    // Moving the vector hands over its buffer, YAML::Node elements are never assigned
+    _entries = std::move(_unique);
+}
+
+size_t cfg::detail::FlatIndex::Footprint() const
+{
+    size_t bytes = _entries.capacity() * sizeof(Entry) + _slots.capacity() * sizeof(uint32_t);
+    for (Entry const &entry : _entries)
+    {
+        // Short keys are held inside the string itself
+        if (entry.key.capacity() > std::string().capacity())
+        {
+            bytes += entry.key.capacity() + 1;
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,139 @@
+#include "cfg.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace
+{
+    /// @brief Parses a config layer, or materializes it if it is a compiled config image
+    YAML::Node load(std::filesystem::path const &_path)
+    {
+        if (cfg::detail::Image::Detect(_path))
+        {
+            std::shared_ptr<const cfg::detail::Image> image = cfg::detail::Image::Map(_path);
+            if (!image)
+            {
+                throw YAML::BadFile(_path.string());
+            }
+            return image->Materialize(image->Root());
+        }
+        return YAML::LoadFile(_path.string());
+    }
+
+    /// @brief Deep-merges a layer over another one into a new node tree. Maps are merged key by key, keeping the
+    /// order of the lower layer and appending the keys, which only the upper layer has. Any other value of the upper
+    /// layer replaces the value of the lower one. Unchanged subtrees are shared with the layers rather than copied.
+    /// Duplicate keys retain the first occurrence, which is what a lookup would find.
+    /// @param _arena sequence, which every merged map is added to before it is filled. yaml-cpp copies the node set
+    /// of a layer into the memory of every node, which the first node of the layer is inserted into. Adding merged
+    /// maps to a common arena first lets them share a single memory, which absorbs every layer only once.
+    YAML::Node merge(YAML::Node const &_lower, YAML::Node const &_upper, YAML::Node &_arena)
+    {
+        if (!_lower.IsMap() || !_upper.IsMap())
+        {
+            return _upper;
+        }
+        std::unordered_map<std::string, std::pair<YAML::Node, YAML::Node>> upper; // Key and value nodes
+        std::vector<std::string> order;
+        for (auto const &kv : _upper)
+        {
+            if (kv.first.IsScalar() && upper.emplace(kv.first.Scalar(), std::make_pair(kv.first, kv.second)).second)
+            {
+                order.push_back(kv.first.Scalar());
+            }
+        }
+        YAML::Node merged(YAML::NodeType::Map);
+        _arena.push_back(merged);
+        std::unordered_set<std::string> seen;
+        for (auto const &kv : _lower)
+        {
+            if (!kv.first.IsScalar() || !seen.insert(kv.first.Scalar()).second)
+            {
+                continue;
+            }
+            auto it = upper.find(kv.first.Scalar());
+            merged.force_insert(kv.first, it != upper.end() ? merge(kv.second, it->second.second, _arena) : kv.second);
+        }
+        for (std::string const &key : order)
+        {
+            if (seen.count(key) == 0)
+            {
+                std::pair<YAML::Node, YAML::Node> const &kv = upper.at(key);
+                merged.force_insert(kv.first, kv.second);
+            }
+        }
+        return merged;
+    }
+} // namespace
+
+boost::optional<cfg::ConfigBase> cfg::GetLayeredConfig_From(std::vector<std::filesystem::path> const &_abs_paths,
+                                                            cfg::LoadOptions const &_options)
+{
+    if (_abs_paths.empty())
+    {
+        cfg::detail::Report("No config files to layer");
+        return boost::none;
+    }
+    // Layers are parsed by a pool of workers, each taking the next unparsed layer, so that loading costs about as
+    // much as parsing the largest layer
+    std::vector<boost::optional<YAML::Node>> layers(_abs_paths.size());
+    std::vector<std::exception_ptr> errors(_abs_paths.size());
+    std::atomic<size_t> next(0);
+    const auto parse = [&]()
+    {
+        for (size_t idx = next.fetch_add(1); idx < _abs_paths.size(); idx = next.fetch_add(1))
+        {
+            try
+            {
+                layers[idx].emplace(load(_abs_paths[idx]));
+            }
+            catch (...)
+            {
+                errors[idx] = std::current_exception();
+            }
+        }
+    };
+    const size_t workers =
+        std::min<size_t>(_abs_paths.size(), std::max<size_t>(1, std::thread::hardware_concurrency()));
+    std::vector<std::thread> pool;
+    for (size_t idx = 1; idx < workers; idx++)
+    {
+        pool.emplace_back(parse);
+    }
+    parse();
+    for (std::thread &worker : pool)
+    {
+        worker.join();
+    }
+    try
+    {
+        for (std::exception_ptr const &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+        YAML::Node root = layers.front().value();
+        YAML::Node arena(YAML::NodeType::Sequence);
+        for (size_t idx = 1; idx < layers.size(); idx++)
+        {
+            // Empty files override nothing
+            if (!layers[idx]->IsNull())
+            {
+                root.reset(merge(root, layers[idx].value(), arena));
+            }
+        }
+        return cfg::ConfigBase(_abs_paths.back(), root, _options);
+    }
+    catch (YAML::Exception const &e)
+    {
+        cfg::detail::Report(e.what());
+        return boost::none;
+    }
+}
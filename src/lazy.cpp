@@ -0,0 +1,273 @@
+#include "lazy.hpp"
+#include "diagnostics.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <streambuf>
+
+namespace
+{
+    /// @brief Read-only stream buffer over a range of memory, which lets yaml-cpp parse a section of the mapped
+    /// file without copying it into a string first
+    class MemoryBuf : public std::streambuf
+    {
+    public:
+        MemoryBuf(char const *_begin, char const *_end)
+        {
+            char *begin = const_cast<char *>(_begin);
+            setg(begin, begin, const_cast<char *>(_end));
+        }
+    };
+
+    /// @brief Parses a range of memory
+    YAML::Node load(char const *_begin, char const *_end)
+    {
+        MemoryBuf buf(_begin, _end);
+        std::istream in(&buf);
+        return YAML::Load(in);
+    }
+
+    /// @brief Checks whether a line could take part in a construct, which spans sections. Anchors and aliases
+    /// could refer across sections, while an odd number of quotes hints at a multi-line quoted scalar. Lines with
+    /// an apostrophe in a plain scalar are rejected as well, which only costs the lazy parsing, not correctness.
+    bool isSplittable(std::string_view line)
+    {
+        size_t double_quotes = 0;
+        size_t single_quotes = 0;
+        for (size_t idx = 0; idx < line.size(); idx++)
+        {
+            const char ch = line[idx];
+            if (ch == '"')
+            {
+                double_quotes++;
+            }
+            else if (ch == '\'')
+            {
+                single_quotes++;
+            }
+            else if (ch == '&' || ch == '*')
+            {
+                const char prev = idx == 0 ? ' ' : line[idx - 1];
+                const char next = idx + 1 == line.size() ? ' ' : line[idx + 1];
+                if (std::strchr(" \t[{,", prev) != nullptr && std::strchr(" \t,]}", next) == nullptr)
+                {
+                    return false;
+                }
+            }
+        }
+        return double_quotes % 2 == 0 && single_quotes % 2 == 0;
+    }
+
+    /// @brief Extracts the key of a line at column zero, which starts a top-level section. Only plain keys are
+    /// accepted, with a value, which is either empty, a block scalar indicator or complete within the line.
+    /// @return false if the line cannot be told to start a section without parsing it
+    bool splitKey(std::string_view line, std::string_view &_key)
+    {
+        if (std::strchr("-?:,[]{}#&*!|>'\"%@`", line.front()) != nullptr || line.substr(0, 3) == "...")
+        {
+            return false;
+        }
+        size_t colon = line.find(':');
+        while (colon != std::string_view::npos && colon + 1 < line.size() && line[colon + 1] != ' ' &&
+               line[colon + 1] != '\t')
+        {
+            colon = line.find(':', colon + 1);
+        }
+        if (colon == std::string_view::npos)
+        {
+            return false;
+        }
+        _key = line.substr(0, colon);
+        while (!_key.empty() && (_key.back() == ' ' || _key.back() == '\t'))
+        {
+            _key.remove_suffix(1);
+        }
+        if (_key.empty() || _key.find(" #") != std::string_view::npos || _key.find("\t#") != std::string_view::npos)
+        {
+            return false;
+        }
+        std::string_view value = line.substr(colon + 1);
+        const size_t first = value.find_first_not_of(" \t");
+        if (first == std::string_view::npos)
+        {
+            return true;
+        }
+        value = value.substr(first, value.find_last_not_of(" \t") - first + 1);
+        switch (value.front())
+        {
+        case '"':
+        case '\'':
+            return value.size() >= 2 && value.back() == value.front();
+        case '[':
+            return value.back() == ']';
+        case '{':
+            return value.back() == '}';
+        default:
+            return true;
+        }
+    }
+} // namespace
+
+bool cfg::detail::LazyDocument::scan()
+{
+    char const *data = _file->Data();
+    const size_t size = _file->Size();
+    // A byte order mark or directives at the start require the parser
+    if (static_cast<unsigned char>(data[0]) == 0xEF || data[0] == '%')
+    {
+        return false;
+    }
+    size_t pos = 0;
+    while (pos < size)
+    {
+        char const *newline = static_cast<char const *>(std::memchr(data + pos, '\n', size - pos));
+        const size_t eol = newline != nullptr ? size_t(newline - data) : size;
+        std::string_view line(data + pos, eol - pos);
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+        if (!isSplittable(line))
+        {
+            return false;
+        }
+        const bool indented = line.empty() || line.front() == ' ' || line.front() == '\t' || line.front() == '#';
+        if (!indented)
+        {
+            std::string_view key;
+            if (!splitKey(line, key))
+            {
+                return false;
+            }
+            if (!_sections.empty())
+            {
+                _sections.back()->end = pos;
+            }
+            _sections.push_back(std::make_unique<Entry>());
+            _sections.back()->key = std::string(key);
+            _sections.back()->begin = pos;
+        }
+        else if (_sections.empty() && line.find_first_not_of(" \t") != std::string_view::npos &&
+                 line[line.find_first_not_of(" \t")] != '#')
+        {
+            // Content before the first top-level key, e.g. an indented root node
+            return false;
+        }
+        pos = eol + 1;
+    }
+    if (_sections.empty())
+    {
+        return false;
+    }
+    _sections.back()->end = size;
+    // Duplicate keys retain the first occurrence, which is what a lookup in the parsed tree would find
+    using EntryPtr = std::unique_ptr<Entry>;
+    std::stable_sort(_sections.begin(), _sections.end(), [](EntryPtr const &lhs, EntryPtr const &rhs)
+                     { return lhs->key < rhs->key; });
+    _sections.erase(std::unique(_sections.begin(), _sections.end(), [](EntryPtr const &lhs, EntryPtr const &rhs)
+                                { return lhs->key == rhs->key; }),
+                    _sections.end());
+    // The pre-scan paged in the whole file, which is not needed any more until sections are parsed
+    _file->Evict();
+    return true;
+}
+
+boost::optional<YAML::Node> cfg::detail::LazyDocument::eager(std::string_view _key) const
+{
+    std::call_once(_eager_parsed, [this]()
+                   {
+        try
+        {
+            _eager.emplace(load(_file->Data(), _file->Data() + _file->Size()));
+        }
+        catch (YAML::ParserException const &pe)
+        {
+            cfg::detail::Report(pe.what());
+        } });
+    if (!_eager.has_value() || !_eager->IsMap())
+    {
+        return boost::none;
+    }
+    for (auto const &kv : _eager.value())
+    {
+        if (kv.first.IsScalar() && kv.first.Scalar() == _key)
+        {
+            return kv.second;
+        }
+    }
+    return boost::none;
+}
+
+std::shared_ptr<const cfg::detail::LazyDocument> cfg::detail::LazyDocument::Scan(std::filesystem::path const &_path)
+{
+    std::shared_ptr<const MappedFile> file = MappedFile::Map(_path);
+    if (!file)
+    {
+        return nullptr;
+    }
+    std::shared_ptr<LazyDocument> document(new LazyDocument(std::move(file)));
+    return document->scan() ? document : nullptr;
+}
+
+boost::optional<YAML::Node> cfg::detail::LazyDocument::Section(std::string_view _key) const
+{
+    auto it = std::lower_bound(_sections.begin(), _sections.end(), _key,
+                               [](std::unique_ptr<Entry> const &entry, std::string_view key)
+                               { return entry->key < key; });
+    if (it == _sections.end() || (*it)->key != _key)
+    {
+        return boost::none;
+    }
+    Entry const &section = **it;
+    std::call_once(section.parsed, [this, &section]()
+                   {
+        try
+        {
+            const YAML::Node root = load(_file->Data() + section.begin, _file->Data() + section.end);
+            if (root.IsMap() && root.size() == 1 && root.begin()->first.IsScalar() &&
+                root.begin()->first.Scalar() == section.key)
+            {
+                section.node.emplace(root.begin()->second);
+                section.consistent = true;
+            }
+        }
+        catch (YAML::ParserException const &)
+        {
+            // Left to the whole file, which reports the error
+        } });
+    if (!section.consistent)
+    {
+        return eager(_key);
+    }
+    return section.node;
+}
+
+std::vector<std::string_view> cfg::detail::LazyDocument::Keys() const
+{
+    std::vector<Entry const *> sections;
+    sections.reserve(_sections.size());
+    for (std::unique_ptr<Entry> const &section : _sections)
+    {
+        sections.push_back(section.get());
+    }
+    std::sort(sections.begin(), sections.end(), [](Entry const *lhs, Entry const *rhs)
+              { return lhs->begin < rhs->begin; });
+    std::vector<std::string_view> keys;
+    keys.reserve(sections.size());
+    for (Entry const *section : sections)
+    {
+        keys.push_back(section->key);
+    }
+    return keys;
+}
+
+size_t cfg::detail::LazyDocument::Footprint() const
+{
+    size_t bytes = _file->Size() + _sections.capacity() * sizeof(std::unique_ptr<Entry>);
+    for (std::unique_ptr<Entry> const &section : _sections)
+    {
+        bytes += sizeof(Entry) + (section->key.capacity() > std::string().capacity() ? section->key.capacity() + 1 : 0);
+    }
+    return bytes;
+}
@@ -0,0 +1,82 @@
+#include "mapped.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CFG_HAS_MMAP 1
+#endif
+
+void cfg::detail::Prefetch(std::filesystem::path const &_path)
+{
+#if defined(CFG_HAS_MMAP) && defined(POSIX_FADV_WILLNEED)
+    const int fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+    // The file is read from start to end by every parser, which allows for aggressive readahead
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    ::close(fd);
+#else
+    (void)_path;
+#endif
+}
+
+cfg::detail::MappedFile::~MappedFile()
+{
+#ifdef CFG_HAS_MMAP
+    ::munmap(_addr, _size);
+#endif
+}
+
+std::shared_ptr<const cfg::detail::MappedFile> cfg::detail::MappedFile::map(int _fd)
+{
+#ifdef CFG_HAS_MMAP
+    if (_fd < 0)
+    {
+        return nullptr;
+    }
+    struct stat st;
+    void *addr = MAP_FAILED;
+    if (::fstat(_fd, &st) == 0 && st.st_size > 0)
+    {
+        addr = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, _fd, 0);
+    }
+    ::close(_fd);
+    if (addr == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    return std::shared_ptr<const MappedFile>(new MappedFile(addr, size_t(st.st_size)));
+#else
+    return nullptr;
+#endif
+}
+
+std::shared_ptr<const cfg::detail::MappedFile> cfg::detail::MappedFile::Map(std::filesystem::path const &_path)
+{
+#ifdef CFG_HAS_MMAP
+    return map(::open(_path.c_str(), O_RDONLY | O_CLOEXEC));
+#else
+    return nullptr;
+#endif
+}
+
+std::shared_ptr<const cfg::detail::MappedFile> cfg::detail::MappedFile::MapSegment(std::string const &_name)
+{
+#ifdef CFG_HAS_MMAP
+    return map(::shm_open(_name.c_str(), O_RDONLY, 0));
+#else
+    return nullptr;
+#endif
+}
+
+void cfg::detail::MappedFile::Evict() const
+{
+#ifdef CFG_HAS_MMAP
+    ::madvise(_addr, _size, MADV_DONTNEED);
+#endif
+}
@@ -0,0 +1,94 @@
+#include "cfg.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    /// @brief Bytes taken by a heap allocation of the given size, including the chunk header and alignment of
+    /// glibc's allocator, which other allocators resemble closely enough for an estimate
+    uint64_t allocation(uint64_t size)
+    {
+        return std::max<uint64_t>(32, (size + 8 + 15) & ~uint64_t(15));
+    }
+
+    /// @brief Bytes taken by the characters of a string, none if they are held inside the string itself
+    uint64_t characters(std::string const &str)
+    {
+        return str.capacity() > std::string().capacity() ? allocation(str.capacity() + 1) : 0;
+    }
+
+    /// @brief Capacity of a vector, which has grown to the given size by appending one element at a time
+    uint64_t grown(uint64_t size)
+    {
+        uint64_t capacity = 1;
+        while (capacity < size)
+        {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    /// @brief Estimates the footprint of a yaml-cpp node tree. Every node consists of the node itself, its
+    /// reference and its data, each of which is owned by a shared pointer with a control block of its own, and the
+    /// node is registered in the node set of the tree's memory.
+    void estimate(YAML::Node const &node, cfg::ConfigMemoryUsage &usage)
+    {
+        constexpr uint64_t CONTROL_BLOCK = 2 * sizeof(void *) + 2 * sizeof(int);
+        constexpr uint64_t SET_ENTRY = 4 * sizeof(void *) + sizeof(std::shared_ptr<void>);
+        static const uint64_t NODE = allocation(sizeof(YAML::detail::node)) +
+                                     allocation(sizeof(YAML::detail::node_ref)) +
+                                     allocation(sizeof(YAML::detail::node_data)) + 3 * allocation(CONTROL_BLOCK) +
+                                     allocation(SET_ENTRY);
+        usage.structure += NODE;
+        usage.strings += characters(node.Tag());
+        switch (node.Type())
+        {
+        case YAML::NodeType::Scalar:
+            usage.strings += characters(node.Scalar());
+            break;
+        case YAML::NodeType::Sequence:
+            usage.structure += node.size() > 0 ? allocation(grown(node.size()) * sizeof(void *)) : 0;
+            for (auto const &child : node)
+            {
+                estimate(child, usage);
+            }
+            break;
+        case YAML::NodeType::Map:
+            usage.structure += node.size() > 0 ? allocation(grown(node.size()) * 2 * sizeof(void *)) : 0;
+            for (auto const &kv : node)
+            {
+                estimate(kv.first, usage);
+                estimate(kv.second, usage);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+} // namespace
+
+cfg::ConfigMemoryUsage cfg::ConfigBase::MemoryUsage() const
+{
+    cfg::ConfigMemoryUsage usage;
+    if (_snapshot->image)
+    {
+        // Sections are laid out as header, nodes, strings, string characters, key index and numeric arrays
+        cfg::detail::ImageHeader const &header = _snapshot->image->Header();
+        usage.structure = header.strings_offset + (header.size - header.numbers_offset);
+        usage.strings = header.keys_offset - header.strings_offset;
+        usage.index = header.numbers_offset - header.keys_offset;
+        usage.exact = true;
+        return usage;
+    }
+    if (_snapshot->lazy)
+    {
+        usage.text = _snapshot->lazy->Footprint();
+        return usage;
+    }
+    estimate(_snapshot->root, usage);
+    if (_snapshot->index)
+    {
+        usage.index = _snapshot->index->Footprint();
+    }
+    return usage;
+}
@@ -0,0 +1,785 @@
+#include "native.hpp"
+#include "mapped.hpp"
+
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    using cfg::detail::NATIVE_NONE;
+
+    /// @brief Set of up to sixteen bytes, which text is scanned for. The scan classifies 16 bytes at a time using
+    /// SSE2 where available, so that runs of ordinary characters are skipped without branching on every byte.
+    class ByteSet
+    {
+        static constexpr size_t CAPACITY = 16; // Maximum number of bytes of the set
+
+        char _bytes[CAPACITY];  // Bytes of the set
+        size_t _count;          // Number of bytes of the set
+#ifdef __SSE2__
+        __m128i _vec[CAPACITY]; // Bytes of the set broadcast to all lanes
+#endif
+
+    public:
+        ByteSet(std::initializer_list<char> _set)
+            : _count(_set.size())
+        {
+            if (_count > CAPACITY)
+            {
+                throw std::length_error("byte set exceeds its capacity");
+            }
+            std::copy_n(_set.begin(), _count, _bytes);
+#ifdef __SSE2__
+            for (size_t idx = 0; idx < _count; idx++)
+            {
+                _vec[idx] = _mm_set1_epi8(_bytes[idx]);
+            }
+#endif
+        }
+
+        /// @brief First byte of the set within the range
+        /// @return position of the byte, last if there is none
+        char const *Find(char const *first, char const *last) const
+        {
+#ifdef __SSE2__
+            for (; last - first >= 16; first += 16)
+            {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<__m128i const *>(first));
+                __m128i hits = _mm_cmpeq_epi8(chunk, _vec[0]);
+                for (size_t idx = 1; idx < _count; idx++)
+                {
+                    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _vec[idx]));
+                }
+                const int mask = _mm_movemask_epi8(hits);
+                if (mask != 0)
+                {
+                    return first + __builtin_ctz(static_cast<unsigned>(mask));
+                }
+            }
+#endif
+            return std::find_first_of(first, last, _bytes, _bytes + _count);
+        }
+    };
+
+    const ByteSet UNSUPPORTED = {'\r', '\t', '\0'};                            // Rejected anywhere in the text
+    const ByteSet LINE_END = {'\n'};                                           // Ends comments
+    const ByteSet BLOCK_PLAIN = {'\n', '#', ':'};                              // May end plain scalars in block context
+    const ByteSet FLOW_PLAIN = {'\n', '#', ':', '?', ',', '[', ']', '{', '}'}; // May end plain scalars in flow context
+    const ByteSet SINGLE_QUOTED = {'\'', '\n'};                                // May end single-quoted scalars
+    const ByteSet DOUBLE_QUOTED = {'"', '\\', '\n'};                           // May end double-quoted scalars
+
+    /// @brief Thrown by the parser, once it encounters anything beyond the subset
+    struct Unsupported
+    {
+    };
+
+    /// @brief Recursive descent parser of the YAML subset. Block nodes are parsed line by line, each parse function
+    /// returning at the first content of the next line, which does not belong to the node.
+    class Parser
+    {
+        char const *_p;                   // Current position
+        char const *_end;                 // End of the text
+        char const *_line;                // Start of the current line
+        int _col;                         // Column of the current content, -1 at the end of the text
+        bool _started;                    // Whether any content or the start of the document is seen
+        cfg::detail::NativeTree &_tree;   // Parsed node tree
+
+        [[noreturn]] static void fail()
+        {
+            throw Unsupported();
+        }
+
+        inline int column() const
+        {
+            return static_cast<int>(_p - _line);
+        }
+
+        /// @brief Whether the current position is followed by a separating space, a line end or the end
+        inline bool separated(char const *p) const
+        {
+            return p == _end || *p == ' ' || *p == '\n';
+        }
+
+        inline bool isSeqEntry() const
+        {
+            return _p != _end && *_p == '-' && separated(_p + 1);
+        }
+
+        inline void spaces()
+        {
+            while (_p != _end && *_p == ' ')
+            {
+                ++_p;
+            }
+        }
+
+        static bool isNull(std::string_view scalar)
+        {
+            return scalar == "~" || scalar == "null" || scalar == "Null" || scalar == "NULL";
+        }
+
+        static std::string_view trim(char const *first, char const *last)
+        {
+            while (last != first && last[-1] == ' ')
+            {
+                --last;
+            }
+            return std::string_view(first, static_cast<size_t>(last - first));
+        }
+
+        /// @brief Appends a node to a sequence or a map
+        uint32_t attach(uint32_t parent, std::string_view key)
+        {
+            const uint32_t child = static_cast<uint32_t>(_tree.nodes.size());
+            _tree.nodes.push_back(
+                cfg::detail::NativeNode{cfg::detail::IMAGE_NULL, key, std::string_view(), NATIVE_NONE, NATIVE_NONE,
+                                        NATIVE_NONE});
+            cfg::detail::NativeNode &node = _tree.nodes[parent];
+            if (node.last == NATIVE_NONE)
+            {
+                node.first = child;
+            }
+            else
+            {
+                _tree.nodes[node.last].next = child;
+            }
+            node.last = child;
+            return child;
+        }
+
+        void scalar(uint32_t node, std::string_view value, bool plain)
+        {
+            _tree.nodes[node].type = plain && isNull(value) ? cfg::detail::IMAGE_NULL : cfg::detail::IMAGE_SCALAR;
+            _tree.nodes[node].scalar = value;
+        }
+
+        /// @brief Moves to the first content of the next line, skipping empty lines and comments
+        void advance()
+        {
+            for (;;)
+            {
+                spaces();
+                if (_p == _end)
+                {
+                    _col = -1;
+                    return;
+                }
+                if (*_p == '#')
+                {
+                    _p = LINE_END.Find(_p, _end);
+                }
+                if (_p != _end && *_p == '\n')
+                {
+                    _line = ++_p;
+                    continue;
+                }
+                if (_p == _end)
+                {
+                    _col = -1;
+                    return;
+                }
+                _col = column();
+                const std::string_view marker(_p, std::min<size_t>(3, static_cast<size_t>(_end - _p)));
+                if (_col == 0 && (marker == "---" || marker == "...") && separated(_p + 3))
+                {
+                    // An explicit start of the document is skipped, while further documents are not supported
+                    if (_started || *_p != '-')
+                    {
+                        fail();
+                    }
+                    _started = true;
+                    _p += 3;
+                    spaces();
+                    if (_p != _end && *_p != '\n' && *_p != '#')
+                    {
+                        fail();
+                    }
+                    continue;
+                }
+                _started = true;
+                return;
+            }
+        }
+
+        /// @brief Finishes the current line, which may only hold a comment, and moves to the next content
+        void finishLine()
+        {
+            spaces();
+            if (_p != _end && *_p == '#' && _p[-1] != ' ')
+            {
+                fail();
+            }
+            if (_p != _end && *_p != '#' && *_p != '\n')
+            {
+                fail();
+            }
+            advance();
+        }
+
+        /// @brief Whether a plain scalar may start at the current position
+        bool plainStart(bool flow) const
+        {
+            switch (*_p)
+            {
+            case '&':
+            case '*':
+            case '!':
+            case '|':
+            case '>':
+            case '%':
+            case '@':
+            case '`':
+            case ',':
+            case '[':
+            case ']':
+            case '{':
+            case '}':
+            case '#':
+            case '\'':
+            case '"':
+                return false;
+            case '?':
+                // yaml-cpp rejects question marks in flow context, even within plain scalars
+                if (flow)
+                {
+                    fail();
+                }
+                return !separated(_p + 1);
+            case '-':
+            case ':':
+                return !separated(_p + 1) &&
+                       !(flow && (_p[1] == ',' || _p[1] == '[' || _p[1] == ']' || _p[1] == '{' || _p[1] == '}'));
+            default:
+                return true;
+            }
+        }
+
+        /// @brief Decodes an escape sequence of a double-quoted scalar following the backslash
+        void escape(std::string &out)
+        {
+            if (_p == _end)
+            {
+                fail();
+            }
+            size_t digits = 0;
+            switch (*_p++)
+            {
+            case '0':
+                out.push_back('\0');
+                return;
+            case 'a':
+                out.push_back('\a');
+                return;
+            case 'b':
+                out.push_back('\b');
+                return;
+            case 't':
+                out.push_back('\t');
+                return;
+            case 'n':
+                out.push_back('\n');
+                return;
+            case 'v':
+                out.push_back('\v');
+                return;
+            case 'f':
+                out.push_back('\f');
+                return;
+            case 'r':
+                out.push_back('\r');
+                return;
+            case 'e':
+                out.push_back('\x1b');
+                return;
+            case '"':
+                out.push_back('"');
+                return;
+            case '\\':
+                out.push_back('\\');
+                return;
+            case 'x':
+                digits = 2;
+                break;
+            case 'u':
+                digits = 4;
+                break;
+            case 'U':
+                digits = 8;
+                break;
+            default:
+                fail();
+            }
+            if (static_cast<size_t>(_end - _p) < digits)
+            {
+                fail();
+            }
+            uint32_t code = 0;
+            for (size_t idx = 0; idx < digits; idx++, _p++)
+            {
+                const char ch = *_p;
+                const int val = ch >= '0' && ch <= '9'   ? ch - '0'
+                                : ch >= 'a' && ch <= 'f' ? ch - 'a' + 10
+                                : ch >= 'A' && ch <= 'F' ? ch - 'A' + 10
+                                                         : -1;
+                if (val < 0)
+                {
+                    fail();
+                }
+                code = code * 16 + static_cast<uint32_t>(val);
+            }
+            // Code points are encoded as UTF-8, surrogates are left to yaml-cpp
+            if (code < 0x80)
+            {
+                out.push_back(static_cast<char>(code));
+            }
+            else if (code < 0x800)
+            {
+                out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+            else if (code < 0x10000 && (code < 0xD800 || code > 0xDFFF))
+            {
+                out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+            else if (code >= 0x10000 && code <= 0x10FFFF)
+            {
+                out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+            else
+            {
+                fail();
+            }
+        }
+
+        /// @brief Parses a single- or double-quoted scalar, which must end on the same line
+        std::string_view quoted()
+        {
+            const char quote = *_p++;
+            ByteSet const &stops = quote == '"' ? DOUBLE_QUOTED : SINGLE_QUOTED;
+            char const *start = _p;
+            std::string *decoded = nullptr;
+            for (;;)
+            {
+                char const *p = stops.Find(_p, _end);
+                if (p == _end || *p == '\n')
+                {
+                    fail();
+                }
+                if (decoded != nullptr)
+                {
+                    decoded->append(_p, p);
+                }
+                else if (*p == '\\' || (quote == '\'' && p + 1 != _end && p[1] == '\''))
+                {
+                    decoded = &_tree.decoded.emplace_back(start, p);
+                }
+                if (*p == '\\')
+                {
+                    _p = p + 1;
+                    escape(*decoded);
+                }
+                else if (quote == '\'' && p + 1 != _end && p[1] == '\'')
+                {
+                    decoded->push_back('\'');
+                    _p = p + 2;
+                }
+                else
+                {
+                    _p = p + 1;
+                    return decoded != nullptr ? std::string_view(*decoded)
+                                              : std::string_view(start, static_cast<size_t>(p - start));
+                }
+            }
+        }
+
+        /// @brief Parses a plain scalar in block context, which ends at the end of the line or at a comment
+        std::string_view plainBlock()
+        {
+            char const *start = _p;
+            char const *p = _p;
+            for (;;)
+            {
+                p = BLOCK_PLAIN.Find(p, _end);
+                if (p == _end || *p == '\n' || (*p == '#' && p[-1] == ' '))
+                {
+                    break;
+                }
+                // A mapping indicator within a value is not supported
+                if (*p == ':' && separated(p + 1))
+                {
+                    fail();
+                }
+                ++p;
+            }
+            _p = p;
+            return trim(start, p);
+        }
+
+        /// @brief Parses a plain scalar in flow context. Plain scalars spanning lines are left to yaml-cpp, which is
+        /// detected by the caller expecting an indicator at the start of the next line.
+        /// @param key whether the scalar is a key, which ends at the mapping indicator
+        std::string_view plainFlow(bool key)
+        {
+            char const *start = _p;
+            char const *p = _p;
+            for (;;)
+            {
+                p = FLOW_PLAIN.Find(p, _end);
+                if (p == _end || *p == '\n' || *p == ',' || *p == ']' || *p == '}' || (*p == '#' && p[-1] == ' '))
+                {
+                    break;
+                }
+                if (*p == '[' || *p == '{' || *p == '?')
+                {
+                    fail();
+                }
+                if (*p == ':' && (separated(p + 1) || p[1] == ',' || p[1] == ']' || p[1] == '}'))
+                {
+                    if (!key)
+                    {
+                        fail();
+                    }
+                    break;
+                }
+                ++p;
+            }
+            _p = p;
+            return trim(start, p);
+        }
+
+        /// @brief Checks a key, which must be a scalar reachable by lookups
+        static std::string_view checkKey(std::string_view key, bool plain)
+        {
+            if (plain && (key.empty() || isNull(key) || key == "<<"))
+            {
+                fail();
+            }
+            return key;
+        }
+
+        /// @brief Parses the key of a block map entry along with the mapping indicator
+        /// @return false if the line is not a map entry, in which case the position is unchanged
+        bool blockKey(std::string_view &key)
+        {
+            char const *start = _p;
+            if (*_p == '"' || *_p == '\'')
+            {
+                key = quoted();
+                spaces();
+                if (_p != _end && *_p == ':' && separated(_p + 1))
+                {
+                    ++_p;
+                    return true;
+                }
+                _p = start;
+                return false;
+            }
+            if (!plainStart(false))
+            {
+                fail();
+            }
+            char const *p = _p;
+            for (;;)
+            {
+                p = BLOCK_PLAIN.Find(p, _end);
+                if (p == _end || *p == '\n' || (*p == '#' && p[-1] == ' '))
+                {
+                    return false;
+                }
+                if (*p == ':' && separated(p + 1))
+                {
+                    break;
+                }
+                ++p;
+            }
+            key = checkKey(trim(_p, p), true);
+            _p = p + 1;
+            return true;
+        }
+
+        /// @brief Skips spaces, line ends and comments within a flow collection. Continuation lines must be
+        /// indented beyond the block node, which the collection belongs to.
+        void flowSpace(int indent)
+        {
+            for (;;)
+            {
+                spaces();
+                if (_p == _end)
+                {
+                    fail();
+                }
+                if (*_p == '#')
+                {
+                    if (_p[-1] != ' ' && _p != _line)
+                    {
+                        fail();
+                    }
+                    _p = LINE_END.Find(_p, _end);
+                    continue;
+                }
+                if (*_p != '\n')
+                {
+                    return;
+                }
+                _line = ++_p;
+                spaces();
+                if (_p != _end && *_p != '\n' && *_p != '#' && column() <= indent)
+                {
+                    fail();
+                }
+            }
+        }
+
+        /// @brief Parses a node within a flow collection
+        void flowNode(uint32_t node, int indent)
+        {
+            if (*_p == '[' || *_p == '{')
+            {
+                flow(node, indent);
+            }
+            else if (*_p == '"' || *_p == '\'')
+            {
+                scalar(node, quoted(), false);
+            }
+            else if (plainStart(true))
+            {
+                scalar(node, plainFlow(false), true);
+            }
+            else
+            {
+                fail();
+            }
+        }
+
+        /// @brief Parses a flow sequence or a flow map, which may span lines
+        void flow(uint32_t node, int indent)
+        {
+            const bool map = *_p++ == '{';
+            const char close = map ? '}' : ']';
+            _tree.nodes[node].type = map ? cfg::detail::IMAGE_MAP : cfg::detail::IMAGE_SEQUENCE;
+            flowSpace(indent);
+            while (*_p != close)
+            {
+                if (!map)
+                {
+                    flowNode(attach(node, std::string_view()), indent);
+                }
+                else
+                {
+                    std::string_view key;
+                    if (*_p == '"' || *_p == '\'')
+                    {
+                        key = quoted();
+                        flowSpace(indent);
+                    }
+                    else if (plainStart(true))
+                    {
+                        key = checkKey(plainFlow(true), true);
+                    }
+                    else
+                    {
+                        fail();
+                    }
+                    // Keys without values are not supported
+                    if (*_p != ':')
+                    {
+                        fail();
+                    }
+                    ++_p;
+                    const uint32_t value = attach(node, key);
+                    flowSpace(indent);
+                    if (*_p != ',' && *_p != '}')
+                    {
+                        flowNode(value, indent);
+                    }
+                }
+                flowSpace(indent);
+                if (*_p == ',')
+                {
+                    ++_p;
+                    flowSpace(indent);
+                }
+                else if (*_p != close)
+                {
+                    fail();
+                }
+            }
+            ++_p;
+        }
+
+        /// @brief Parses a node, which starts after a map key or a sequence entry indicator on the same line
+        void inlineNode(uint32_t node, int indent)
+        {
+            if (*_p == '[' || *_p == '{')
+            {
+                flow(node, indent);
+            }
+            else if (*_p == '"' || *_p == '\'')
+            {
+                scalar(node, quoted(), false);
+            }
+            else if (plainStart(false))
+            {
+                scalar(node, plainBlock(), true);
+            }
+            else
+            {
+                fail();
+            }
+            finishLine();
+        }
+
+        /// @brief Parses a block sequence, whose entries start at the given column
+        void sequence(uint32_t node, int indent)
+        {
+            _tree.nodes[node].type = cfg::detail::IMAGE_SEQUENCE;
+            while (_col == indent && isSeqEntry())
+            {
+                const uint32_t item = attach(node, std::string_view());
+                ++_p;
+                spaces();
+                if (_p == _end || *_p == '\n' || *_p == '#')
+                {
+                    finishLine();
+                    if (_col > indent)
+                    {
+                        block(item, _col);
+                    }
+                }
+                else
+                {
+                    // Compact nested nodes, e.g. "- key: value", are indented by their column
+                    _col = column();
+                    block(item, _col);
+                }
+            }
+            if (_col > indent)
+            {
+                fail();
+            }
+        }
+
+        /// @brief Parses a block map, whose keys start at the given column
+        void map(uint32_t node, int indent)
+        {
+            _tree.nodes[node].type = cfg::detail::IMAGE_MAP;
+            while (_col == indent && !isSeqEntry())
+            {
+                std::string_view key;
+                if (!blockKey(key))
+                {
+                    fail();
+                }
+                const uint32_t value = attach(node, key);
+                spaces();
+                if (_p != _end && *_p != '\n' && *_p != '#')
+                {
+                    if (isSeqEntry())
+                    {
+                        fail();
+                    }
+                    inlineNode(value, indent);
+                    continue;
+                }
+                finishLine();
+                if (_col > indent)
+                {
+                    block(value, _col);
+                }
+                else if (_col == indent && isSeqEntry())
+                {
+                    // Sequences may be indented like the key, whose value they are
+                    sequence(value, indent);
+                }
+            }
+            if (_col > indent || (_col == indent && isSeqEntry()))
+            {
+                fail();
+            }
+        }
+
+        /// @brief Parses a block node starting at the current position, which lies at the given column
+        void block(uint32_t node, int indent)
+        {
+            if (isSeqEntry())
+            {
+                sequence(node, indent);
+                return;
+            }
+            if (*_p == '[' || *_p == '{')
+            {
+                inlineNode(node, indent - 1);
+                return;
+            }
+            char const *start = _p;
+            std::string_view key;
+            if (blockKey(key))
+            {
+                _p = start;
+                map(node, indent);
+                return;
+            }
+            inlineNode(node, indent - 1);
+        }
+
+    public:
+        Parser(std::string_view _text, cfg::detail::NativeTree &_tree)
+            : _p(_text.data()), _end(_text.data() + _text.size()), _line(_text.data()), _col(-1), _started(false),
+              _tree(_tree) {}
+
+        void Parse()
+        {
+            if (UNSUPPORTED.Find(_p, _end) != _end || (_end - _p >= 3 && std::string_view(_p, 3) == "\xEF\xBB\xBF"))
+            {
+                fail();
+            }
+            _tree.nodes.clear();
+            _tree.decoded.clear();
+            _tree.nodes.push_back(cfg::detail::NativeNode{cfg::detail::IMAGE_NULL, std::string_view(),
+                                                          std::string_view(), NATIVE_NONE, NATIVE_NONE, NATIVE_NONE});
+            advance();
+            if (_col >= 0)
+            {
+                block(0, _col);
+            }
+            if (_col >= 0)
+            {
+                fail();
+            }
+        }
+    };
+} // namespace
+
+bool cfg::detail::ParseNative(std::string_view _text, cfg::detail::NativeTree &_tree)
+{
+    try
+    {
+        Parser(_text, _tree).Parse();
+        return true;
+    }
+    catch (Unsupported const &)
+    {
+        return false;
+    }
+}
+
+std::shared_ptr<const cfg::detail::Image> cfg::detail::LoadNative(std::filesystem::path const &_path)
+{
+    std::shared_ptr<const MappedFile> mapped = MappedFile::Map(_path);
+    cfg::detail::NativeTree tree;
+    if (!mapped || !ParseNative(std::string_view(mapped->Data(), mapped->Size()), tree))
+    {
+        return nullptr;
+    }
+    return Image::FromBuffer(CompileImage(tree));
+}
@@ -0,0 +1,329 @@
+#include "published.hpp"
+#include "diagnostics.hpp"
+#include "native.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CFG_HAS_SHM 1
+#endif
+
+namespace
+{
+    constexpr char CONTROL_MAGIC[8] = {'C', 'F', 'G', 'S', 'H', 'M', '0', '1'};
+
+    /// @brief Control segment of a published config, which holds the generation of the currently published image.
+    /// The image of every generation lives in a segment of its own, which is never modified once published.
+    struct Control
+    {
+        char magic[8];                    // Identifies the control segment
+        std::atomic<uint64_t> generation; // Currently published generation, 0 if none
+    };
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "generations are shared across processes");
+
+    std::string controlName(std::string const &name)
+    {
+        return "/" + name;
+    }
+
+    std::string imageName(std::string const &name, uint64_t generation)
+    {
+        return "/" + name + "." + std::to_string(generation);
+    }
+
+    /// @brief Control segment of a mapping, nullptr if the mapping does not hold one
+    Control const *control(cfg::detail::MappedFile const &mapped)
+    {
+        if (mapped.Size() < sizeof(Control) || std::memcmp(mapped.Data(), CONTROL_MAGIC, sizeof(CONTROL_MAGIC)) != 0)
+        {
+            return nullptr;
+        }
+        return reinterpret_cast<Control const *>(mapped.Data());
+    }
+
+    /// @brief Compiles a config file into a compiled config image, using the native parser where the file allows
+    std::vector<char> compile(std::filesystem::path const &path)
+    {
+        if (cfg::detail::Image::Detect(path))
+        {
+            std::ifstream in(path, std::ios::binary);
+            std::vector<char> image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            if (!cfg::detail::Image::FromBuffer(std::vector<char>(image)))
+            {
+                throw YAML::BadFile(path.string());
+            }
+            return image;
+        }
+        std::shared_ptr<const cfg::detail::MappedFile> mapped = cfg::detail::MappedFile::Map(path);
+        cfg::detail::NativeTree tree;
+        if (mapped && cfg::detail::ParseNative(std::string_view(mapped->Data(), mapped->Size()), tree))
+        {
+            return cfg::detail::CompileImage(tree);
+        }
+        return cfg::detail::CompileImage(YAML::LoadFile(path.string()));
+    }
+
+#ifdef CFG_HAS_SHM
+    /// @brief Writes an image into a new shared memory segment, replacing any stale segment of the same name
+    bool writeImage(std::string const &name, std::vector<char> const &image)
+    {
+        ::shm_unlink(name.c_str());
+        const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            return false;
+        }
+        void *addr = MAP_FAILED;
+        if (::ftruncate(fd, off_t(image.size())) == 0)
+        {
+            addr = ::mmap(nullptr, image.size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (addr == MAP_FAILED)
+        {
+            ::shm_unlink(name.c_str());
+            return false;
+        }
+        std::memcpy(addr, image.data(), image.size());
+        ::munmap(addr, image.size());
+        return true;
+    }
+
+    /// @brief Writable mapping of a control segment, which holds an exclusive lock on the segment for its lifetime,
+    /// so that publications under the same name are serialized across processes
+    class ControlLock
+    {
+        int _fd;           // Descriptor of the control segment, -1 if not open
+        Control *_control; // Mapped control segment, nullptr if not mapped
+
+    public:
+        /// @brief Opens, locks and maps the control segment
+        /// @param name segment name
+        /// @param create whether to create the segment, if it does not exist
+        ControlLock(std::string const &name, bool create)
+            : _fd(::shm_open(name.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0), 0644)), _control(nullptr)
+        {
+            struct stat st;
+            if (_fd < 0 || ::flock(_fd, LOCK_EX) != 0 || ::fstat(_fd, &st) != 0)
+            {
+                return;
+            }
+            // A new segment is zero-filled, i.e. it holds no generation yet
+            const bool empty = st.st_size == 0;
+            if (empty && (!create || ::ftruncate(_fd, sizeof(Control)) != 0))
+            {
+                return;
+            }
+            if (!empty && size_t(st.st_size) < sizeof(Control))
+            {
+                return;
+            }
+            void *addr = ::mmap(nullptr, sizeof(Control), PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+            if (addr == MAP_FAILED)
+            {
+                return;
+            }
+            _control = static_cast<Control *>(addr);
+            if (empty)
+            {
+                std::memcpy(_control->magic, CONTROL_MAGIC, sizeof(CONTROL_MAGIC));
+            }
+            else if (std::memcmp(_control->magic, CONTROL_MAGIC, sizeof(CONTROL_MAGIC)) != 0)
+            {
+                ::munmap(addr, sizeof(Control));
+                _control = nullptr;
+            }
+        }
+
+        ControlLock(ControlLock const &) = delete;
+        ControlLock &operator=(ControlLock const &) = delete;
+
+        ~ControlLock()
+        {
+            if (_control != nullptr)
+            {
+                ::munmap(_control, sizeof(Control));
+            }
+            if (_fd >= 0)
+            {
+                ::close(_fd);
+            }
+        }
+
+        /// @brief Mapped control segment, nullptr if it cannot be opened, locked or mapped
+        inline Control *Get() const
+        {
+            return _control;
+        }
+    };
+#endif
+
+    /// @brief Whether a name is usable as name of a published config. Dots are reserved for separating the
+    /// generation in the names of image segments, hence a name cannot collide with an image of another name.
+    bool validName(std::string const &name)
+    {
+        if (name.empty() || name.find_first_of("/.") != std::string::npos)
+        {
+            cfg::detail::Report("Invalid name of a published config: " + name);
+            return false;
+        }
+        return true;
+    }
+} // namespace
+
+cfg::PublishedConfig::PublishedConfig(std::string const &_name,
+                                      std::shared_ptr<const cfg::detail::MappedFile> _control, uint64_t _generation,
+                                      std::unique_ptr<const cfg::ConfigBase> _initial)
+    : _name(_name), _control(std::move(_control)), _cell(std::move(_initial)), _generation(_generation) {}
+
+std::unique_ptr<const cfg::ConfigBase> cfg::PublishedConfig::attach(std::string const &_name,
+                                                                    cfg::detail::MappedFile const &_control,
+                                                                    uint64_t &_generation)
+{
+    Control const *ctl = control(_control);
+    // The image of a generation is unlinked once a newer one is published, hence the generation is read again
+    // if its image cannot be attached
+    uint64_t generation = ctl->generation.load(std::memory_order_acquire);
+    while (generation != 0)
+    {
+        std::shared_ptr<const cfg::detail::Image> image =
+            cfg::detail::Image::FromMapping(cfg::detail::MappedFile::MapSegment(imageName(_name, generation)));
+        if (image)
+        {
+            _generation = generation;
+            return std::unique_ptr<const cfg::ConfigBase>(new cfg::ConfigBase(controlName(_name), std::move(image)));
+        }
+        const uint64_t published = ctl->generation.load(std::memory_order_acquire);
+        if (published == generation)
+        {
+            break;
+        }
+        generation = published;
+    }
+    return nullptr;
+}
+
+cfg::ConfigBase cfg::PublishedConfig::Snapshot() const
+{
+    return _cell.Read([](cfg::ConfigBase const &base)
+                      { return base; });
+}
+
+uint64_t cfg::PublishedConfig::PublishedGeneration() const
+{
+    return control(*_control)->generation.load(std::memory_order_acquire);
+}
+
+bool cfg::PublishedConfig::Refresh()
+{
+    if (PublishedGeneration() == _generation.load())
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_refresh_mutex);
+    uint64_t generation = 0;
+    std::unique_ptr<const cfg::ConfigBase> base = attach(_name, *_control, generation);
+    if (!base || generation <= _generation.load())
+    {
+        return false;
+    }
+    _cell.Publish(std::move(base));
+    _generation.store(generation);
+    return true;
+}
+
+bool cfg::PublishConfig(std::filesystem::path const &_abs_path, std::string const &_name)
+{
+    if (!validName(_name))
+    {
+        return false;
+    }
+    std::vector<char> image;
+    try
+    {
+        image = compile(_abs_path);
+    }
+    catch (YAML::Exception const &e)
+    {
+        cfg::detail::Report(e.what());
+        return false;
+    }
+#ifdef CFG_HAS_SHM
+    ControlLock lock(controlName(_name), true);
+    Control *ctl = lock.Get();
+    if (ctl == nullptr)
+    {
+        cfg::detail::Report("Failed to open the control segment of published config " + _name);
+        return false;
+    }
+    const uint64_t previous = ctl->generation.load(std::memory_order_acquire);
+    if (!writeImage(imageName(_name, previous + 1), image))
+    {
+        cfg::detail::Report("Failed to write the image of published config " + _name);
+        return false;
+    }
+    ctl->generation.store(previous + 1, std::memory_order_release);
+    if (previous != 0)
+    {
+        ::shm_unlink(imageName(_name, previous).c_str());
+    }
+    return true;
+#else
+    cfg::detail::Report("Shared memory is not supported on this platform");
+    return false;
+#endif
+}
+
+bool cfg::UnpublishConfig(std::string const &_name)
+{
+    if (!validName(_name))
+    {
+        return false;
+    }
+#ifdef CFG_HAS_SHM
+    ControlLock lock(controlName(_name), false);
+    Control *ctl = lock.Get();
+    if (ctl == nullptr)
+    {
+        return false;
+    }
+    // Attached processes find no generation to refresh to
+    const uint64_t generation = ctl->generation.exchange(0, std::memory_order_acq_rel);
+    if (generation != 0)
+    {
+        ::shm_unlink(imageName(_name, generation).c_str());
+    }
+    ::shm_unlink(controlName(_name).c_str());
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<cfg::PublishedConfig> cfg::GetPublishedConfig_From(std::string const &_name)
+{
+    if (!validName(_name))
+    {
+        return nullptr;
+    }
+    std::shared_ptr<const cfg::detail::MappedFile> _control = cfg::detail::MappedFile::MapSegment(controlName(_name));
+    if (!_control || control(*_control) == nullptr)
+    {
+        return nullptr;
+    }
+    uint64_t generation = 0;
+    std::unique_ptr<const cfg::ConfigBase> base = cfg::PublishedConfig::attach(_name, *_control, generation);
+    if (!base)
+    {
+        return nullptr;
+    }
+    return std::unique_ptr<cfg::PublishedConfig>(
+        new cfg::PublishedConfig(_name, std::move(_control), generation, std::move(base)));
+}
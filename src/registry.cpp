@@ -0,0 +1,196 @@
+#include "cfg.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+namespace
+{
+    /// @brief Identity of a version of a config file
+    struct Identity
+    {
+        dev_t device;
+        ino_t inode;
+        off_t size;
+        struct timespec mtime;
+
+        inline bool operator==(Identity const &other) const
+        {
+            return device == other.device && inode == other.inode && size == other.size &&
+                   mtime.tv_sec == other.mtime.tv_sec && mtime.tv_nsec == other.mtime.tv_nsec;
+        }
+    };
+
+    /// @brief Config held by the registry
+    struct Entry
+    {
+        Identity identity;                                           // Version of the file, which is held
+        uint64_t id;                                                 // Distinguishes loads of the same file
+        std::shared_future<boost::optional<cfg::ConfigBase>> config; // Config, pending while being parsed
+        uint64_t charge;                                             // Memory footprint, zero while being parsed
+        std::list<std::string>::iterator lru;                        // Position in the eviction order
+    };
+
+    /// @brief Process-wide registry of shared configs
+    struct Registry
+    {
+        std::mutex mutex;                               // Guards all members
+        std::unordered_map<std::string, Entry> entries; // Configs by canonical path and load options
+        std::list<std::string> lru;                     // Keys of the configs, most recently loaded first
+        cfg::SharedConfigUsage usage;                   // Usage of the registry
+        std::atomic<bool> enabled{false};               // Whether the capacity is non-zero, read without the lock
+        uint64_t next_id = 0;                           // Id of the next config to be parsed
+
+        /// @brief Drops a config from the registry
+        void drop(std::unordered_map<std::string, Entry>::iterator it)
+        {
+            usage.bytes -= it->second.charge;
+            lru.erase(it->second.lru);
+            entries.erase(it);
+        }
+
+        /// @brief Evicts the least recently loaded configs, until the registry fits into its capacity. Configs
+        /// being parsed are not charged yet, hence never evicted.
+        void evict()
+        {
+            for (auto it = lru.end(); usage.bytes > usage.capacity && it != lru.begin();)
+            {
+                --it;
+                auto entry = entries.find(*it);
+                if (entry->second.charge > 0)
+                {
+                    it = std::next(it);
+                    drop(entry);
+                }
+            }
+        }
+    };
+
+    Registry &registry()
+    {
+        static Registry _registry;
+        return _registry;
+    }
+} // namespace
+
+void cfg::SetSharedConfigCapacity(uint64_t bytes)
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.usage.capacity = bytes;
+    reg.enabled.store(bytes > 0);
+    if (bytes == 0)
+    {
+        // Configs being parsed are left to their loaders, which drop them once parsed
+        for (auto it = reg.entries.begin(); it != reg.entries.end();)
+        {
+            auto next = std::next(it);
+            if (it->second.charge > 0)
+            {
+                reg.drop(it);
+            }
+            it = next;
+        }
+        return;
+    }
+    reg.evict();
+}
+
+cfg::SharedConfigUsage cfg::GetSharedConfigUsage()
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    cfg::SharedConfigUsage usage = reg.usage;
+    usage.entries = reg.entries.size();
+    return usage;
+}
+
+boost::optional<cfg::ConfigBase> cfg::detail::Shared(std::filesystem::path const &path,
+                                                     cfg::LoadOptions const &options,
+                                                     std::function<boost::optional<cfg::ConfigBase>()> const &load)
+{
+    Registry &reg = registry();
+    if (!reg.enabled.load())
+    {
+        return load();
+    }
+    std::error_code error;
+    const std::filesystem::path canonical = std::filesystem::canonical(path, error);
+    struct stat st;
+    if (error || ::stat(canonical.c_str(), &st) != 0)
+    {
+        // Unreadable files are left to the loader to report
+        return load();
+    }
+    const Identity identity{st.st_dev, st.st_ino, st.st_size, st.st_mtim};
+    std::string key = canonical.string();
+    key += '\0';
+    key += options.flat_index ? '1' : '0';
+    key += options.lazy ? '1' : '0';
+    key += options.native ? '1' : '0';
+    key += options.compact ? '1' : '0';
+    std::unique_lock<std::mutex> lock(reg.mutex);
+    auto it = reg.entries.find(key);
+    if (it != reg.entries.end() && it->second.identity == identity)
+    {
+        reg.usage.hits++;
+        reg.lru.splice(reg.lru.begin(), reg.lru, it->second.lru);
+        std::shared_future<boost::optional<cfg::ConfigBase>> config = it->second.config;
+        lock.unlock();
+        return config.get();
+    }
+    if (it != reg.entries.end())
+    {
+        // The file has changed, while the stale config stays valid for those, who still use it
+        reg.drop(it);
+    }
+    std::promise<boost::optional<cfg::ConfigBase>> promise;
+    const uint64_t id = reg.next_id++;
+    reg.lru.push_front(key);
+    reg.entries.emplace(key, Entry{identity, id, promise.get_future().share(), 0, reg.lru.begin()});
+    reg.usage.loads++;
+    lock.unlock();
+
+    boost::optional<cfg::ConfigBase> config;
+    try
+    {
+        config = load();
+        promise.set_value(config);
+    }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+        lock.lock();
+        it = reg.entries.find(key);
+        if (it != reg.entries.end() && it->second.id == id)
+        {
+            reg.drop(it);
+        }
+        throw;
+    }
+
+    // The footprint is measured outside of the lock, as estimating it walks the whole node tree
+    const uint64_t charge = config.has_value() ? std::max<uint64_t>(1, config->MemoryUsage().Total()) : 0;
+    lock.lock();
+    it = reg.entries.find(key);
+    if (it == reg.entries.end() || it->second.id != id)
+    {
+        return config;
+    }
+    if (!config.has_value() || reg.usage.capacity == 0)
+    {
+        reg.drop(it);
+        return config;
+    }
+    it->second.charge = charge;
+    reg.usage.bytes += it->second.charge;
+    reg.evict();
+    return config;
+}
@@ -0,0 +1,152 @@
+#include "reload.hpp"
+
+#include <cerrno>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+cfg::ReloadableConfig::ReloadableConfig(std::filesystem::path const &_cfg_path, cfg::LoadOptions const &_options,
+                                        std::unique_ptr<const cfg::ConfigBase> _initial)
+    : _path(_cfg_path), _options(_options), _cell(std::move(_initial)), _generation(0), _wake_fd(-1),
+      _next_subscription(0) {}
+
+cfg::ReloadableConfig::~ReloadableConfig()
+{
+#ifdef __linux__
+    if (_wake_fd >= 0)
+    {
+        const uint64_t wake = 1;
+        (void)::write(_wake_fd, &wake, sizeof(wake));
+        _watcher.join();
+        ::close(_wake_fd);
+    }
+#endif
+}
+
+void cfg::ReloadableConfig::watch()
+{
+#ifdef __linux__
+    const int _inotify_fd = ::inotify_init1(IN_CLOEXEC);
+    if (_inotify_fd < 0)
+    {
+        return;
+    }
+    // Watch the directory rather than the file, because an atomic replacement of the file by rename would
+    // otherwise end the watch along with the replaced inode.
+    const std::filesystem::path _dir = _path.has_parent_path() ? _path.parent_path() : std::filesystem::path(".");
+    if (::inotify_add_watch(_inotify_fd, _dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0 ||
+        (_wake_fd = ::eventfd(0, EFD_CLOEXEC)) < 0)
+    {
+        ::close(_inotify_fd);
+        return;
+    }
+    _watcher = std::thread([this, _inotify_fd]()
+                           {
+        const std::string _file_name = _path.filename().string();
+        alignas(inotify_event) char buffer[4096];
+        pollfd fds[2] = {{_inotify_fd, POLLIN, 0}, {_wake_fd, POLLIN, 0}};
+        while (::poll(fds, 2, -1) >= 0 || errno == EINTR)
+        {
+            if (fds[1].revents & POLLIN)
+            {
+                break;
+            }
+            if (!(fds[0].revents & POLLIN))
+            {
+                continue;
+            }
+            const ssize_t len = ::read(_inotify_fd, buffer, sizeof(buffer));
+            bool changed = false;
+            for (ssize_t pos = 0; pos < len;)
+            {
+                inotify_event const *event = reinterpret_cast<inotify_event const *>(buffer + pos);
+                changed = changed || (event->len > 0 && _file_name == event->name);
+                pos += sizeof(inotify_event) + event->len;
+            }
+            if (changed)
+            {
+                Reload();
+            }
+        }
+        ::close(_inotify_fd); });
+#endif
+}
+
+cfg::ConfigBase cfg::ReloadableConfig::Snapshot() const
+{
+    return _cell.Read([](cfg::ConfigBase const &base)
+                      { return base; });
+}
+
+bool cfg::ReloadableConfig::Reload()
+{
+    std::lock_guard<std::mutex> lock(_reload_mutex);
+    boost::optional<cfg::ConfigBase> base = cfg::GetConfig_From(_path, _options);
+    if (!base.has_value())
+    {
+        return false;
+    }
+    const cfg::ConfigBase previous = Snapshot();
+    _cell.Publish(std::make_unique<const cfg::ConfigBase>(base.value()));
+    _generation.fetch_add(1);
+    notify(previous, base.value());
+    return true;
+}
+
+uint64_t cfg::ReloadableConfig::Subscribe(std::string const &prefix, cfg::ConfigSubscriber subscriber)
+{
+    std::lock_guard<std::mutex> lock(_subscribers_mutex);
+    const uint64_t id = _next_subscription++;
+    _subscribers.emplace(id, std::make_pair(prefix, std::move(subscriber)));
+    return id;
+}
+
+void cfg::ReloadableConfig::Unsubscribe(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(_subscribers_mutex);
+    _subscribers.erase(id);
+}
+
+void cfg::ReloadableConfig::notify(cfg::ConfigBase const &_previous, cfg::ConfigBase const &_current)
+{
+    // Callbacks are called without holding the lock, so that they can subscribe or unsubscribe themselves
+    std::vector<std::pair<std::string, cfg::ConfigSubscriber>> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(_subscribers_mutex);
+        for (auto const &subscription : _subscribers)
+        {
+            subscribers.push_back(subscription.second);
+        }
+    }
+    if (subscribers.empty())
+    {
+        return;
+    }
+    const cfg::ConfigDiff diff = _previous.Diff(_current);
+    for (auto const &subscriber : subscribers)
+    {
+        if (diff.Touches(subscriber.first))
+        {
+            subscriber.second(diff, _current);
+        }
+    }
+}
+
+std::unique_ptr<cfg::ReloadableConfig> cfg::GetReloadableConfig_From(std::filesystem::path const &_abs_path,
+                                                                     cfg::LoadOptions const &_options)
+{
+    boost::optional<cfg::ConfigBase> base = cfg::GetConfig_From(_abs_path, _options);
+    if (!base.has_value())
+    {
+        return nullptr;
+    }
+    std::unique_ptr<cfg::ReloadableConfig> reloadable(
+        new cfg::ReloadableConfig(_abs_path, _options, std::make_unique<const cfg::ConfigBase>(base.value())));
+    reloadable->watch();
+    return reloadable;
+}
@@ -0,0 +1,326 @@
+#include "stats.hpp"
+#include "index.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace
+{
+    /// @brief Access statistics of a key of one config
+    struct ConfigKeyStats
+    {
+        std::filesystem::path config; // Path of the config, which the key is looked up in
+        cfg::KeyStats stats;          // Statistics of the key
+    };
+
+    /// @brief Access statistics of keys by the combined hash of the config and the key. Keys with colliding hashes
+    /// share a bucket.
+    using StatsTable = std::unordered_map<uint64_t, std::vector<ConfigKeyStats>>;
+
+    /// @brief Looks up the statistics of a key of a config, adding them if the key is read for the first time
+    cfg::KeyStats &find(StatsTable &_table, std::filesystem::path const &_config, std::string_view _key)
+    {
+        // Paths are hashed and compared by their characters rather than component-wise, which is cheaper
+        const uint64_t hash = std::hash<std::filesystem::path::string_type>()(_config.native());
+        std::vector<ConfigKeyStats> &bucket = _table[cfg::detail::Hash(_key) ^ (hash * 31)];
+        for (ConfigKeyStats &entry : bucket)
+        {
+            if (entry.stats.key == _key && entry.config.native() == _config.native())
+            {
+                return entry.stats;
+            }
+        }
+        bucket.emplace_back();
+        bucket.back().config = _config;
+        bucket.back().stats.key = std::string(_key);
+        return bucket.back().stats;
+    }
+
+    /// @brief Adds the statistics of one config, or of all configs if none is given, from one table to another
+    void merge(StatsTable &_into, StatsTable const &_from, std::filesystem::path const *_config = nullptr)
+    {
+        for (auto const &kv : _from)
+        {
+            for (ConfigKeyStats const &entry : kv.second)
+            {
+                if (_config == nullptr || entry.config.native() == _config->native())
+                {
+                    find(_into, entry.config, entry.stats.key).Merge(entry.stats);
+                }
+            }
+        }
+    }
+
+    /// @brief Access statistics recorded by a single thread. The owning thread is the only writer, but the table is
+    /// guarded nevertheless, because reports are merged from any thread. The lock is hence uncontended, except while
+    /// a report is being merged.
+    struct Shard
+    {
+        std::mutex mutex; // Guards the table
+        StatsTable table; // Statistics recorded by the thread
+    };
+
+    /// @brief Shards of all running threads, along with the statistics of threads, which have exited
+    struct Registry
+    {
+        std::mutex mutex;            // Guards the registry
+        std::vector<Shard *> shards; // Shards of running threads
+        StatsTable retired;          // Statistics merged from the shards of exited threads
+    };
+
+    Registry &registry()
+    {
+        static Registry _registry;
+        return _registry;
+    }
+
+    /// @brief Registers the shard of a thread on its first lookup, and retires it when the thread exits
+    class ThreadShard
+    {
+        Shard _shard; // Statistics recorded by the thread
+
+    public:
+        ThreadShard()
+        {
+            Registry &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.shards.push_back(&_shard);
+        }
+
+        ~ThreadShard()
+        {
+            Registry &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.shards.erase(std::remove(reg.shards.begin(), reg.shards.end(), &_shard), reg.shards.end());
+            std::lock_guard<std::mutex> shard_lock(_shard.mutex);
+            merge(reg.retired, _shard.table);
+        }
+
+        Shard &Get()
+        {
+            return _shard;
+        }
+    };
+
+    Shard &shard()
+    {
+        thread_local ThreadShard _shard;
+        return _shard.Get();
+    }
+
+    /// @brief Counts a lookup by its outcome
+    void count(cfg::KeyStats &_stats, cfg::Error _outcome)
+    {
+        switch (_outcome)
+        {
+        case cfg::Error::None:
+            _stats.hits++;
+            break;
+        case cfg::Error::Missing:
+            _stats.misses++;
+            break;
+        default:
+            _stats.failures++;
+            break;
+        }
+    }
+
+    /// @brief Histogram bucket of a latency, i.e. the number of significant bits of the latency in ns
+    size_t bucket(uint64_t _ns)
+    {
+        size_t bits = 0;
+        while (_ns != 0 && bits < cfg::LATENCY_BUCKETS - 1)
+        {
+            _ns >>= 1;
+            bits++;
+        }
+        return bits;
+    }
+
+    /// @brief Escapes a string for a JSON string literal
+    std::string escape(std::string_view _str)
+    {
+        std::ostringstream out;
+        for (char ch : _str)
+        {
+            if (ch == '"' || ch == '\\')
+            {
+                out << '\\' << ch;
+            }
+            else if (static_cast<unsigned char>(ch) < 0x20)
+            {
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(ch) << std::dec;
+            }
+            else
+            {
+                out << ch;
+            }
+        }
+        return out.str();
+    }
+
+    /// @brief Renders the statistics of a key as JSON object
+    void writeJson(std::ostream &_out, cfg::KeyStats const &_stats)
+    {
+        _out << "{\"key\": \"" << escape(_stats.key) << "\", \"reads\": " << _stats.Reads()
+             << ", \"hits\": " << _stats.hits << ", \"misses\": " << _stats.misses
+             << ", \"failures\": " << _stats.failures << ", \"total_ns\": " << _stats.total_ns
+             << ", \"p50_ns\": " << _stats.Percentile(0.5) << ", \"p99_ns\": " << _stats.Percentile(0.99)
+             << ", \"latency\": [";
+        for (size_t idx = 0; idx < _stats.latency.size(); idx++)
+        {
+            _out << (idx == 0 ? "" : ", ") << _stats.latency[idx];
+        }
+        _out << "]}";
+    }
+
+    /// @brief Renders the statistics of a key as a line of text
+    void writeText(std::ostream &_out, cfg::KeyStats const &_stats)
+    {
+        _out << _stats.Reads() << " reads (" << _stats.hits << " hits, " << _stats.misses << " misses, "
+             << _stats.failures << " failures), p50 <= " << _stats.Percentile(0.5)
+             << " ns, p99 <= " << _stats.Percentile(0.99) << " ns";
+    }
+} // namespace
+
+uint64_t cfg::KeyStats::Percentile(double fraction) const
+{
+    uint64_t timed = 0;
+    for (uint64_t num : latency)
+    {
+        timed += num;
+    }
+    if (timed == 0)
+    {
+        return 0;
+    }
+    const double rank = fraction * double(timed);
+    uint64_t seen = 0;
+    for (size_t idx = 0; idx < latency.size(); idx++)
+    {
+        seen += latency[idx];
+        if (double(seen) >= rank && latency[idx] > 0)
+        {
+            // The last bucket is unbounded
+            return idx + 1 == latency.size() ? std::numeric_limits<uint64_t>::max() : (uint64_t(1) << idx) - 1;
+        }
+    }
+    return std::numeric_limits<uint64_t>::max();
+}
+
+void cfg::KeyStats::Merge(cfg::KeyStats const &other)
+{
+    hits += other.hits;
+    misses += other.misses;
+    failures += other.failures;
+    total_ns += other.total_ns;
+    for (size_t idx = 0; idx < latency.size(); idx++)
+    {
+        latency[idx] += other.latency[idx];
+    }
+}
+
+std::string cfg::AccessReport::ToJson() const
+{
+    std::ostringstream out;
+    out << "{\"enabled\": " << (enabled ? "true" : "false") << ", \"total\": ";
+    writeJson(out, total);
+    out << ", \"hot\": [";
+    for (size_t idx = 0; idx < hot.size(); idx++)
+    {
+        out << (idx == 0 ? "" : ", ");
+        writeJson(out, hot[idx]);
+    }
+    out << "], \"unread\": [";
+    for (size_t idx = 0; idx < unread.size(); idx++)
+    {
+        out << (idx == 0 ? "" : ", ") << '"' << escape(unread[idx]) << '"';
+    }
+    out << "]}";
+    return out.str();
+}
+
+std::string cfg::AccessReport::ToText() const
+{
+    std::ostringstream out;
+    if (!enabled)
+    {
+        out << "Access statistics are not recorded, build with CFG_WITH_INSTRUMENTATION\n";
+        return out.str();
+    }
+    out << "All keys: ";
+    writeText(out, total);
+    out << "\nHot keys:\n";
+    for (KeyStats const &stats : hot)
+    {
+        out << "  " << stats.key << ": ";
+        writeText(out, stats);
+        out << '\n';
+    }
+    out << "Unread keys:\n";
+    for (std::string const &key : unread)
+    {
+        out << "  " << key << '\n';
+    }
+    return out.str();
+}
+
+void cfg::ResetAccessStats()
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.retired.clear();
+    for (Shard *_shard : reg.shards)
+    {
+        std::lock_guard<std::mutex> shard_lock(_shard->mutex);
+        _shard->table.clear();
+    }
+}
+
+void cfg::detail::Record(std::filesystem::path const &config, std::string_view key, cfg::Error outcome, uint64_t ns)
+{
+    Shard &_shard = shard();
+    std::lock_guard<std::mutex> lock(_shard.mutex);
+    cfg::KeyStats &stats = find(_shard.table, config, key);
+    count(stats, outcome);
+    stats.total_ns += ns;
+    stats.latency[bucket(ns)]++;
+}
+
+void cfg::detail::Record(std::filesystem::path const &config, std::string_view key, cfg::Error outcome)
+{
+    Shard &_shard = shard();
+    std::lock_guard<std::mutex> lock(_shard.mutex);
+    count(find(_shard.table, config, key), outcome);
+}
+
+std::vector<cfg::KeyStats> cfg::detail::CollectAccessStats(std::filesystem::path const &config)
+{
+    StatsTable merged;
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        merge(merged, reg.retired, &config);
+        for (Shard *_shard : reg.shards)
+        {
+            std::lock_guard<std::mutex> shard_lock(_shard->mutex);
+            merge(merged, _shard->table, &config);
+        }
+    }
+    std::vector<cfg::KeyStats> stats;
+    for (auto &kv : merged)
+    {
+        for (ConfigKeyStats &entry : kv.second)
+        {
+            stats.push_back(std::move(entry.stats));
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,605 @@
+#include "writable.hpp"
+#include "diagnostics.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string_view>
+#include <unordered_set>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CFG_HAS_FSYNC 1
+#endif
+
+namespace
+{
+    constexpr size_t NONE = std::string::npos;
+
+    /// @brief Change of the text of a config file, which replaces a range of the text
+    struct Splice
+    {
+        size_t begin;            // Offset of the first replaced character
+        size_t end;              // Offset past the last replaced character, equal to begin for insertions
+        std::string replacement; // Replacing text
+    };
+
+    /// @brief Emits a node. Flow style keeps collections on a single line, so that they can replace a value in place.
+    std::string emit(YAML::Node const &node, bool flow)
+    {
+        YAML::Emitter out;
+        if (flow)
+        {
+            out.SetMapFormat(YAML::Flow);
+            out.SetSeqFormat(YAML::Flow);
+        }
+        out << node;
+        return out.good() ? std::string(out.c_str()) : std::string();
+    }
+
+    /// @brief Keys, which are inserted into a block map, along with the maps they create. Kept apart from yaml-cpp
+    /// maps, whose lookups and insertions are costly for thousands of keys.
+    struct InsertedKeys
+    {
+        std::vector<std::pair<std::string, InsertedKeys>> children; // Inserted keys in the order they are made
+        std::unordered_map<std::string, size_t> positions;          // Positions of the inserted keys
+        boost::optional<YAML::Node> value;                          // Value, if the key is not a map of keys
+
+        /// @brief Inserted key against its segments, inserting it unless inserted already
+        InsertedKeys &Insert(std::vector<std::string> const &segments, size_t level)
+        {
+            if (level == segments.size())
+            {
+                return *this;
+            }
+            auto inserted = positions.emplace(segments[level], children.size());
+            if (inserted.second)
+            {
+                children.emplace_back(segments[level], InsertedKeys());
+            }
+            return children[inserted.first->second].second.Insert(segments, level + 1);
+        }
+
+        /// @brief Appends the inserted keys in block style
+        /// @param indent indentation of the keys
+        void Emit(size_t indent, std::string &block) const
+        {
+            for (auto const &child : children)
+            {
+                YAML::Emitter out;
+                if (!child.second.value.has_value())
+                {
+                    out << child.first;
+                    block.append(indent, ' ').append(out.c_str()).append(":\n");
+                    child.second.Emit(indent + 2, block);
+                    continue;
+                }
+                // Values are emitted along with their keys rather than inserted into a map, which would merge the
+                // memory of the whole tree the values are assigned to
+                out << YAML::BeginMap << YAML::Key << child.first << YAML::Value << child.second.value.value()
+                    << YAML::EndMap;
+                std::istringstream lines(out.c_str());
+                for (std::string line; std::getline(lines, line);)
+                {
+                    block.append(indent, ' ').append(line).append("\n");
+                }
+            }
+        }
+    };
+
+    /// @brief Keys, which are inserted into a block map in front of its first key
+    struct Insertion
+    {
+        size_t indent;     // Indentation of the keys of the map
+        InsertedKeys keys; // Inserted keys
+    };
+
+    std::vector<std::string> split(std::string const &key)
+    {
+        std::vector<std::string> segments;
+        size_t begin = 0;
+        for (size_t end = key.find('.'); end != NONE; begin = end + 1, end = key.find('.', begin))
+        {
+            segments.push_back(key.substr(begin, end - begin));
+        }
+        segments.push_back(key.substr(begin));
+        return segments;
+    }
+
+    /// @brief Whether a node can hold keys, i.e. it is a map, null or not yet defined
+    bool mapping(YAML::Node const &node)
+    {
+        return !node.IsDefined() || node.IsMap() || node.IsNull();
+    }
+
+    /// @brief Assigns a value to a key of a node tree, creating maps along the key, where keys are missing or null
+    /// @return false if a node along the key is neither a map nor null
+    bool assign(YAML::Node root, std::vector<std::string> const &segments, size_t first, YAML::Node const &value)
+    {
+        YAML::Node node = root;
+        for (size_t idx = first; idx + 1 < segments.size(); idx++)
+        {
+            if (!mapping(node))
+            {
+                return false;
+            }
+            // Assigning a node would rebind the referenced node inside the tree, hence the handle is reset
+            node.reset(node[segments[idx]]);
+        }
+        if (!mapping(node))
+        {
+            return false;
+        }
+        node[segments.back()] = value;
+        return true;
+    }
+
+    /// @brief Whether a node is written as flow collection
+    bool flowStyle(std::string const &text, YAML::Node const &node)
+    {
+        const size_t pos = node.Mark().pos;
+        return pos < text.size() && (text[pos] == '[' || text[pos] == '{');
+    }
+
+    /// @brief Whether a scalar denotes null
+    bool nullToken(std::string_view token)
+    {
+        return token == "~" || token == "null" || token == "Null" || token == "NULL";
+    }
+
+    /// @brief Finds the end of a scalar written on a single line
+    /// @param flow whether the scalar is inside a flow collection, where it ends at an indicator
+    /// @return offset past the scalar, NONE if it spans multiple lines
+    size_t scanScalar(std::string const &text, size_t pos, bool flow)
+    {
+        if (text[pos] == '\'' || text[pos] == '"')
+        {
+            const char quote = text[pos];
+            for (size_t idx = pos + 1; idx < text.size() && text[idx] != '\n'; idx++)
+            {
+                if (quote == '"' && text[idx] == '\\')
+                {
+                    idx++;
+                }
+                else if (text[idx] == quote && quote == '\'' && idx + 1 < text.size() && text[idx + 1] == '\'')
+                {
+                    idx++;
+                }
+                else if (text[idx] == quote)
+                {
+                    return idx + 1;
+                }
+            }
+            return NONE;
+        }
+        size_t end = pos;
+        for (; end < text.size() && text[end] != '\n' && text[end] != '\r'; end++)
+        {
+            if ((text[end] == '#' && end > pos && (text[end - 1] == ' ' || text[end - 1] == '\t')) ||
+                (flow && (text[end] == ',' || text[end] == ']' || text[end] == '}')))
+            {
+                break;
+            }
+        }
+        while (end > pos && (text[end - 1] == ' ' || text[end - 1] == '\t'))
+        {
+            end--;
+        }
+        return end > pos ? end : NONE;
+    }
+
+    /// @brief Finds the end of a flow collection
+    /// @return offset past the closing bracket, NONE if it is not closed
+    size_t scanFlow(std::string const &text, size_t pos)
+    {
+        size_t depth = 0;
+        for (size_t idx = pos; idx < text.size(); idx++)
+        {
+            const char ch = text[idx];
+            if (ch == '\'' || ch == '"')
+            {
+                idx = scanScalar(text, idx, true);
+                if (idx == NONE)
+                {
+                    return NONE;
+                }
+                idx--;
+            }
+            else if (ch == '#' && (text[idx - 1] == ' ' || text[idx - 1] == '\t'))
+            {
+                idx = text.find('\n', idx);
+                if (idx == NONE)
+                {
+                    return NONE;
+                }
+            }
+            else if (ch == '[' || ch == '{')
+            {
+                depth++;
+            }
+            else if ((ch == ']' || ch == '}') && --depth == 0)
+            {
+                return idx + 1;
+            }
+        }
+        return NONE;
+    }
+
+    /// @brief Patches the text of a config file with the latest change of every key, replacing values in place and
+    /// inserting missing keys into existing block maps
+    /// @param text text of the config file
+    /// @param root node tree parsed from the text
+    /// @param changes latest change of every key, in the order they are made
+    /// @return patched text, none if any change cannot be patched
+    boost::optional<std::string> patch(std::string const &text, YAML::Node const &root,
+                                       std::vector<std::pair<std::string, YAML::Node>> const &changes)
+    {
+        // Changes of keys underneath other changed keys would overlap
+        std::unordered_set<std::string> keys;
+        for (auto const &change : changes)
+        {
+            keys.insert(change.first);
+        }
+        for (auto const &change : changes)
+        {
+            for (size_t end = change.first.find('.'); end != NONE; end = change.first.find('.', end + 1))
+            {
+                if (keys.count(change.first.substr(0, end)) != 0)
+                {
+                    return boost::none;
+                }
+            }
+        }
+        std::vector<Splice> splices;
+        std::map<size_t, Insertion> insertions;
+        for (auto const &change : changes)
+        {
+            const std::vector<std::string> segments = split(change.first);
+            YAML::Node node = root;
+            bool flow = flowStyle(text, root);
+            size_t level = 0;
+            for (; level < segments.size() && node.IsMap(); level++)
+            {
+                boost::optional<YAML::Node> next;
+                for (auto const &kv : node)
+                {
+                    if (kv.first.IsScalar() && kv.first.Scalar() == segments[level])
+                    {
+                        next = kv.second;
+                        break;
+                    }
+                }
+                if (!next.has_value())
+                {
+                    break;
+                }
+                node.reset(next.value());
+                flow = flow || flowStyle(text, node);
+            }
+            if (level == segments.size())
+            {
+                // Only scalars and flow collections are known to end where their text ends
+                const size_t begin = node.Mark().pos;
+                size_t end = NONE;
+                if (node.IsScalar() || (node.IsNull() && begin < text.size()))
+                {
+                    end = scanScalar(text, begin, flow);
+                    // The mark of an empty value is the one of the next token
+                    if (node.IsNull() && end != NONE && !nullToken(std::string_view(text).substr(begin, end - begin)))
+                    {
+                        end = NONE;
+                    }
+                }
+                else if ((node.IsSequence() || node.IsMap()) && flowStyle(text, node))
+                {
+                    end = scanFlow(text, begin);
+                }
+                const std::string replacement = emit(change.second, true);
+                if (end == NONE || replacement.empty() || replacement.find('\n') != NONE)
+                {
+                    return boost::none;
+                }
+                splices.push_back(Splice{begin, end, replacement});
+                continue;
+            }
+            if (!node.IsMap() || flow || (level > 0 && node.size() == 0))
+            {
+                return boost::none;
+            }
+            size_t pos = text.size();
+            size_t indent = 0;
+            if (level > 0)
+            {
+                // Keys are inserted in front of the first key of a nested map, at the start of its line
+                const YAML::Mark mark = node.begin()->first.Mark();
+                indent = size_t(mark.column);
+                pos = size_t(mark.pos) - indent;
+                if (mark.column > mark.pos || text.find_first_not_of(' ', pos) != size_t(mark.pos))
+                {
+                    return boost::none;
+                }
+            }
+            // Changes of keys underneath other changed keys are ruled out, hence every inserted value is a leaf
+            insertions.try_emplace(pos, Insertion{indent, InsertedKeys()})
+                .first->second.keys.Insert(segments, level)
+                .value = change.second;
+        }
+        for (auto const &insertion : insertions)
+        {
+            std::string block;
+            insertion.second.keys.Emit(insertion.second.indent, block);
+            if (insertion.first == text.size() && !text.empty() && text.back() != '\n')
+            {
+                block.insert(block.begin(), '\n');
+            }
+            splices.push_back(Splice{insertion.first, insertion.first, block});
+        }
+        std::stable_sort(splices.begin(), splices.end(), [](Splice const &lhs, Splice const &rhs)
+                         { return lhs.begin < rhs.begin; });
+        std::string patched;
+        size_t cursor = 0;
+        for (Splice const &splice : splices)
+        {
+            if (splice.begin < cursor)
+            {
+                return boost::none;
+            }
+            patched.append(text, cursor, splice.begin - cursor).append(splice.replacement);
+            cursor = splice.end;
+        }
+        return patched.append(text, cursor, NONE);
+    }
+
+#ifdef CFG_HAS_FSYNC
+    /// @brief Writes the text of a config file into a temporary file of a unique name next to it, carrying the
+    /// permissions of the config file. The text is flushed to the disk before the file is renamed, otherwise a crash
+    /// could leave an empty or truncated config file behind on file systems, which reorder the rename before the data.
+    /// @return path of the temporary file, none if it cannot be written
+    boost::optional<std::filesystem::path> writeTemporary(std::filesystem::path const &path, std::string const &text)
+    {
+        std::string tmp_path = path.string() + ".XXXXXX";
+        const int fd = ::mkstemp(tmp_path.data());
+        if (fd < 0)
+        {
+            cfg::detail::Report("Failed to create a temporary file for " + path.string());
+            return boost::none;
+        }
+        struct stat st;
+        bool written = ::stat(path.c_str(), &st) != 0 || ::fchmod(fd, st.st_mode & 07777) == 0;
+        for (size_t offset = 0; written && offset < text.size();)
+        {
+            const ssize_t count = ::write(fd, text.data() + offset, text.size() - offset);
+            written = count > 0 || (count < 0 && errno == EINTR);
+            offset += count > 0 ? static_cast<size_t>(count) : 0;
+        }
+        written = written && ::fsync(fd) == 0;
+        written = ::close(fd) == 0 && written;
+        if (!written)
+        {
+            cfg::detail::Report("Failed to write " + tmp_path);
+            ::unlink(tmp_path.c_str());
+            return boost::none;
+        }
+        return std::filesystem::path(tmp_path);
+    }
+
+    /// @brief Flushes the entries of a directory to the disk, such that a rename within it persists
+    void syncDirectory(std::filesystem::path const &dir)
+    {
+        const int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd >= 0)
+        {
+            ::fsync(fd);
+            ::close(fd);
+        }
+    }
+#else
+    /// @brief Writes the text of a config file into a temporary file of a unique name next to it, carrying the
+    /// permissions of the config file
+    /// @return path of the temporary file, none if it cannot be written
+    boost::optional<std::filesystem::path> writeTemporary(std::filesystem::path const &path, std::string const &text)
+    {
+        static std::atomic<uint64_t> next{0};
+        const std::filesystem::path tmp_path =
+            path.string() + "." + std::to_string(std::random_device()()) + "." + std::to_string(next.fetch_add(1));
+        {
+            std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+            if (!out.write(text.data(), static_cast<std::streamsize>(text.size())) || !out.flush())
+            {
+                cfg::detail::Report("Failed to write " + tmp_path.string());
+                std::error_code ec;
+                std::filesystem::remove(tmp_path, ec);
+                return boost::none;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::permissions(tmp_path, std::filesystem::status(path, ec).permissions(), ec);
+        return tmp_path;
+    }
+
+    /// @brief Directory entries cannot be flushed explicitly on this platform
+    void syncDirectory(std::filesystem::path const &) {}
+#endif
+
+    /// @brief Writes the text of a config file into a temporary file and renames it over the config file, hence the
+    /// config file holds either its previous or its new text, even if the process or the system crashes meanwhile.
+    /// Every write uses a temporary file of its own, so that concurrent writers do not overwrite each other's text.
+    bool write(std::filesystem::path const &path, std::string const &text)
+    {
+        const boost::optional<std::filesystem::path> tmp_path = writeTemporary(path, text);
+        if (!tmp_path.has_value())
+        {
+            return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp_path.value(), path, ec);
+        if (ec)
+        {
+            cfg::detail::Report("Failed to write " + path.string() + ": " + ec.message());
+            std::filesystem::remove(tmp_path.value(), ec);
+            return false;
+        }
+        syncDirectory(path.parent_path());
+        return true;
+    }
+} // namespace
+
+cfg::WritableConfig::WritableConfig(std::filesystem::path const &_cfg_path, cfg::LoadOptions const &_options,
+                                    std::unique_ptr<const cfg::ConfigBase> _initial)
+    : _path(_cfg_path), _options(_options), _cell(std::move(_initial)), _generation(0) {}
+
+void cfg::WritableConfig::set(std::string const &_key, YAML::Node &&_value)
+{
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    _pending.emplace_back(_key, std::move(_value));
+}
+
+void cfg::WritableConfig::Discard()
+{
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    _pending.clear();
+}
+
+size_t cfg::WritableConfig::Pending()
+{
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    return _pending.size();
+}
+
+cfg::ConfigBase cfg::WritableConfig::Snapshot() const
+{
+    return _cell.Read([](cfg::ConfigBase const &base)
+                      { return base; });
+}
+
+bool cfg::WritableConfig::Commit()
+{
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    if (_pending.empty())
+    {
+        return true;
+    }
+    std::string text;
+    YAML::Node root;
+    YAML::Node expected;
+    try
+    {
+        std::ifstream in(_path, std::ios::binary);
+        if (!in)
+        {
+            cfg::detail::Report("Failed to read " + _path.string());
+            return false;
+        }
+        text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        root.reset(YAML::Load(text));
+        expected.reset(YAML::Clone(root));
+    }
+    catch (YAML::Exception const &e)
+    {
+        cfg::detail::Report(e.what());
+        return false;
+    }
+    // The expected config applies every change in order, while the text is patched with the latest change of
+    // every key only
+    std::vector<size_t> positions;
+    std::unordered_set<std::string> seen;
+    for (size_t pos = _pending.size(); pos-- > 0;)
+    {
+        if (seen.insert(_pending[pos].first).second)
+        {
+            positions.push_back(pos);
+        }
+    }
+    // Nodes are copied rather than swapped, because assigning a node would rebind the referenced node
+    std::vector<std::pair<std::string, YAML::Node>> latest;
+    latest.reserve(positions.size());
+    for (auto it = positions.rbegin(); it != positions.rend(); ++it)
+    {
+        latest.push_back(_pending[*it]);
+    }
+    for (auto const &change : _pending)
+    {
+        if (change.first.empty() || !assign(expected, split(change.first), 0, change.second))
+        {
+            cfg::detail::Report("Cannot set config value " + change.first + " in " + _path.string());
+            return false;
+        }
+    }
+    boost::optional<std::string> patched = patch(text, root, latest);
+    YAML::Node committed = expected;
+    if (patched.has_value())
+    {
+        // A patch is used only if it yields exactly the expected config
+        try
+        {
+            committed.reset(YAML::Load(patched.value()));
+            if (cfg::detail::HashTree::Build(committed).hash != cfg::detail::HashTree::Build(expected).hash)
+            {
+                patched = boost::none;
+            }
+        }
+        catch (YAML::Exception const &)
+        {
+            patched = boost::none;
+        }
+    }
+    if (!patched.has_value())
+    {
+        committed.reset(expected);
+    }
+    std::string output = patched.has_value() ? patched.value() : emit(expected, false);
+    if (output.empty())
+    {
+        // An empty text means that the emitter failed, which must not replace the config file
+        cfg::detail::Report("Failed to emit the committed config for " + _path.string());
+        return false;
+    }
+    if (!patched.has_value())
+    {
+        output += '\n';
+    }
+    if (!write(_path, output))
+    {
+        return false;
+    }
+    _pending.clear();
+    // The committed node tree is published as it is, unless the file is meant to be loaded otherwise
+    boost::optional<cfg::ConfigBase> base;
+    if (_options.lazy || _options.native || _options.compact)
+    {
+        base = cfg::GetConfig_From(_path, _options);
+        if (!base.has_value())
+        {
+            // The file is written already, hence readers must not keep the previous config
+            cfg::detail::Report("Failed to reload " + _path.string() + ", publishing the committed node tree");
+        }
+    }
+    if (base.has_value())
+    {
+        _cell.Publish(std::make_unique<const cfg::ConfigBase>(base.value()));
+    }
+    else
+    {
+        _cell.Publish(std::unique_ptr<const cfg::ConfigBase>(new cfg::ConfigBase(_path, committed, _options)));
+    }
+    _generation.fetch_add(1);
+    return true;
+}
+
+std::unique_ptr<cfg::WritableConfig> cfg::GetWritableConfig_From(std::filesystem::path const &_abs_path,
+                                                                 cfg::LoadOptions const &_options)
+{
+    boost::optional<cfg::ConfigBase> base = cfg::GetConfig_From(_abs_path, _options);
+    if (!base.has_value())
+    {
+        return nullptr;
+    }
+    return std::unique_ptr<cfg::WritableConfig>(
+        new cfg::WritableConfig(_abs_path, _options, std::make_unique<const cfg::ConfigBase>(base.value())));
+}
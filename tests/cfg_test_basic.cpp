@@ -1,4 +1,8 @@
 #include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
 #include <unordered_map>
 
 #include <catch2/catch_test_macros.hpp>
@@ -6,6 +10,41 @@
 #include "cfg.hpp"
 #include "types.hpp"
 
+namespace app
+{
+    struct Road
+    {
+        double length;
+        double width;
+        double hue;
+        std::string name;
+        cfg::Vec3D point;
+        bool debug = false;
+    };
+
+    CFG_SCHEMA(Road,
+               CFG_FIELD(length, "road.dims.length"),
+               CFG_FIELD(width, "road.dims.width"),
+               CFG_FIELD(hue, "road.color.hue"),
+               CFG_FIELD(name, "attributes.name"),
+               CFG_FIELD(point, "attributes.point"),
+               CFG_FIELD(debug, "attributes.debug"));
+
+    struct Broken
+    {
+        double pi = 0.;
+        double lanes = 2.;
+        double name = 0.;
+        cfg::Vec3I malformed;
+    };
+
+    CFG_SCHEMA(Broken,
+               CFG_FIELD(pi, "pi"),
+               CFG_FIELD(lanes, "road.dims.lanes"),
+               CFG_FIELD(name, "attributes.name"),
+               CFG_FIELD(malformed, "error.malformed"));
+} // namespace app
+
 SCENARIO("config must be read from valid config file")
 {
     GIVEN("a valid file path")
@@ -145,3 +184,761 @@ SCENARIO("config can be read from valid config file and keys")
         }
     }
 }
+
+SCENARIO("config can be read using precompiled keys")
+{
+    GIVEN("a config base api obtained from valid file path")
+    {
+        const std::filesystem::path t_config_path = "../../tests/test_config_basic.yaml";
+        const cfg::ConfigBase base = cfg::GetConfig_From(std::filesystem::absolute(t_config_path)).value();
+        WHEN("keys are compiled into handles")
+        {
+            const cfg::Key PI = base.Compile("pi");
+            const cfg::Key ATTRIBUTES_POINT = base.Compile("attributes.point");
+            const cfg::Key ROAD_COLOR_SATURATION = base.Compile("road.color.saturation");
+            const cfg::Key ROAD_COLOR_INVALID = base.Compile("road.color.invalid");
+            const cfg::Key PI_INVALID = base.Compile("pi.invalid");
+            const cfg::Key ROAD_COLOR = base.Compile("road.color");
+            THEN("handles retain the key structure")
+            {
+                REQUIRE(PI.Depth() == 1);
+                REQUIRE(ROAD_COLOR_SATURATION.Depth() == 3);
+                REQUIRE(ROAD_COLOR_SATURATION.Path() == "road.color.saturation");
+            }
+            THEN("config value can be obtained using the handles")
+            {
+                const cfg::Vec3D e_point_xyz = {2.3, 5.2, 5.9};
+                REQUIRE(base.Get<double>(PI).value() == base.Get<double>("pi").value());
+                REQUIRE(base.Get<cfg::Vec3D>(ATTRIBUTES_POINT).value() == e_point_xyz);
+                REQUIRE(base.Get<double>(ROAD_COLOR_SATURATION).value() == 0.2);
+            }
+            THEN("config value cannot be obtained using handles of missing or non-leaf keys")
+            {
+                REQUIRE_FALSE(base.Get<double>(ROAD_COLOR_INVALID).has_value());
+                REQUIRE_FALSE(base.Get<double>(PI_INVALID).has_value());
+                REQUIRE_FALSE(base.Get<double>(ROAD_COLOR).has_value());
+            }
+            THEN("handles can be used with another config instance")
+            {
+                const cfg::ConfigBase other = cfg::GetConfig_From(std::filesystem::absolute(t_config_path)).value();
+                REQUIRE(other.Get<double>(ROAD_COLOR_SATURATION).value() == 0.2);
+                REQUIRE_FALSE(other.Get<double>(ROAD_COLOR_INVALID).has_value());
+            }
+        }
+    }
+}
+
+SCENARIO("config can be read using flattened key index")
+{
+    GIVEN("a config base api obtained from valid file path with flattened key index")
+    {
+        const std::filesystem::path t_config_path = "../../tests/test_config_basic.yaml";
+        cfg::LoadOptions options;
+        options.flat_index = true;
+        const cfg::ConfigBase base = cfg::GetConfig_From(std::filesystem::absolute(t_config_path), options).value();
+        WHEN("valid key is used")
+        {
+            THEN("config value can be obtained")
+            {
+                const cfg::Vec3I e_rgb = {255, 255, 255};
+                REQUIRE(base.Get<double>("pi").value() == 3.14159);
+                REQUIRE(base.Get<std::string>("attributes.name").value() == "some name");
+                REQUIRE(base.Get<cfg::Vec3I>("attributes.rgb").value() == e_rgb);
+                REQUIRE(base.Get<double>("road.dims.height").value() == 5.1);
+                REQUIRE(base.Get<double>(base.Compile("road.color.value")).value() == 0.2);
+            }
+        }
+        WHEN("invalid or malformed key is used")
+        {
+            THEN("config value cannot be obtained")
+            {
+                REQUIRE_FALSE(base.Get<double>("").has_value());
+                REQUIRE_FALSE(base.Get<double>("road.color.invalid").has_value());
+                REQUIRE_FALSE(base.Get<double>("road..color").has_value());
+                REQUIRE_FALSE(base.Get<cfg::Vec3I>("error.malformed").has_value());
+            }
+        }
+        WHEN("a handle compiled by another config is used")
+        {
+            const cfg::ConfigBase other = cfg::GetConfig_From(std::filesystem::absolute(t_config_path)).value();
+            const cfg::Key ROAD_DIMS_WIDTH = other.Compile("road.dims.width");
+            THEN("config value is obtained from the index")
+            {
+                REQUIRE(base.Get<double>(ROAD_DIMS_WIDTH).value() == 12.);
+            }
+        }
+    }
+}
+
+SCENARIO("config copies share the parsed config")
+{
+    GIVEN("a config base api obtained from a config file, which changes afterwards")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::temp_directory_path() / "cfg_test_copy.yaml";
+        std::ofstream(t_config_path, std::ios::trunc) << "road:\n  width: 12.\n";
+        const cfg::ConfigBase base = cfg::GetConfig_From(t_config_path).value();
+        std::ofstream(t_config_path, std::ios::trunc) << "road:\n  width: 24.\n";
+        WHEN("config is copied")
+        {
+            const cfg::ConfigBase copy = base;
+            cfg::ConfigBase assigned = cfg::GetConfig_From(t_config_path).value();
+            assigned = copy;
+            THEN("copies retain the config as it was read")
+            {
+                REQUIRE(copy == base);
+                REQUIRE(copy.Get<double>("road.width").value() == 12.);
+                REQUIRE(assigned.Get<double>("road.width").value() == 12.);
+            }
+        }
+        std::filesystem::remove(t_config_path);
+    }
+}
+
+SCENARIO("config can be read concurrently")
+{
+    GIVEN("a config base api shared by many threads")
+    {
+        const std::filesystem::path t_config_path = "../../tests/test_config_basic.yaml";
+        const cfg::ConfigBase base = cfg::GetConfig_From(std::filesystem::absolute(t_config_path)).value();
+        WHEN("threads look up valid and invalid keys at the same time")
+        {
+            std::vector<std::thread> threads;
+            std::vector<int> failures(8, 0);
+            for (size_t idx = 0; idx < failures.size(); idx++)
+            {
+                threads.emplace_back([&base, &failures, idx]()
+                                     {
+                    for (int iter = 0; iter < 1000; iter++)
+                    {
+                        const std::string missing = "road.color.missing" + std::to_string(iter);
+                        if (base.Get<double>(missing).has_value() || base.Get<double>("invalid").has_value() ||
+                            base.Get<double>("road.dims.width").value_or(0.) != 12.)
+                        {
+                            failures[idx]++;
+                        }
+                    } });
+            }
+            for (std::thread &thread : threads)
+            {
+                thread.join();
+            }
+            THEN("every thread obtains the config values and misses do not insert keys")
+            {
+                for (int failure : failures)
+                {
+                    REQUIRE(failure == 0);
+                }
+                REQUIRE_FALSE(base.Get<double>("road.color.missing0").has_value());
+            }
+        }
+    }
+}
+
+SCENARIO("config values can be memoized")
+{
+    GIVEN("a config base api obtained from valid file path")
+    {
+        const std::filesystem::path t_config_path = "../../tests/test_config_basic.yaml";
+        const cfg::ConfigBase base = cfg::GetConfig_From(std::filesystem::absolute(t_config_path)).value();
+        WHEN("config values are looked up repeatedly")
+        {
+            const cfg::Vec3D e_point_xyz = {2.3, 5.2, 5.9};
+            const cfg::ConfigBase copy = base;
+            const boost::optional<cfg::Vec3D const &> point = base.Cached<cfg::Vec3D>("attributes.point");
+            const boost::optional<cfg::Vec3D const &> point_again = copy.Cached<cfg::Vec3D>("attributes.point");
+            const boost::optional<cfg::Vec3D const &> point_handle = base.Cached<cfg::Vec3D>(
+                base.Compile("attributes.point"));
+            THEN("the same memoized value is returned")
+            {
+                REQUIRE(point.has_value());
+                REQUIRE(point.value() == e_point_xyz);
+                REQUIRE(&point.value() == &point_again.value());
+                REQUIRE(&point.value() == &point_handle.value());
+            }
+            THEN("values are memoized per value type")
+            {
+                REQUIRE(base.Cached<double>("road.dims.width").value() == 12.);
+                REQUIRE(base.Cached<std::string>("road.dims.width").value() == "12.");
+            }
+        }
+        WHEN("missing or malformed config values are looked up")
+        {
+            THEN("config values cannot be obtained")
+            {
+                REQUIRE_FALSE(base.Cached<double>("road.dims.invalid").has_value());
+                REQUIRE_FALSE(base.Cached<double>("road.dims.invalid").has_value());
+                REQUIRE_FALSE(base.Cached<cfg::Vec3I>("error.malformed").has_value());
+            }
+        }
+    }
+}
+
+SCENARIO("config can be read lazily section by section")
+{
+    GIVEN("a config base api obtained from valid file path with lazy parsing")
+    {
+        const std::filesystem::path t_config_path = "../../tests/test_config_basic.yaml";
+        cfg::LoadOptions options;
+        options.lazy = true;
+        const cfg::ConfigBase base = cfg::GetConfig_From(std::filesystem::absolute(t_config_path), options).value();
+        WHEN("valid key is used")
+        {
+            THEN("config value can be obtained")
+            {
+                const cfg::Vec3D e_point_xyz = {2.3, 5.2, 5.9};
+                REQUIRE(base.Get<double>("pi").value() == 3.14159);
+                REQUIRE(base.Get<std::string>("attributes.name").value() == "some name");
+                REQUIRE(base.Get<cfg::Vec3D>("attributes.point").value() == e_point_xyz);
+                REQUIRE(base.Get<double>(base.Compile("road.color.value")).value() == 0.2);
+                REQUIRE(base.Cached<double>("road.dims.height").value() == 5.1);
+            }
+        }
+        WHEN("invalid or malformed key is used")
+        {
+            THEN("config value cannot be obtained")
+            {
+                REQUIRE_FALSE(base.Get<double>("").has_value());
+                REQUIRE_FALSE(base.Get<double>("invalid").has_value());
+                REQUIRE_FALSE(base.Get<double>("road.color.invalid").has_value());
+                REQUIRE_FALSE(base.Get<double>(base.Compile("pi.invalid")).has_value());
+                REQUIRE_FALSE(base.Get<cfg::Vec3I>("error.malformed").has_value());
+            }
+        }
+    }
+    GIVEN("config files, which cannot be split into sections without parsing them")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::temp_directory_path() / "cfg_test_lazy.yaml";
+        cfg::LoadOptions options;
+        options.lazy = true;
+        WHEN("sections refer to each other using anchors and aliases")
+        {
+            std::ofstream(t_config_path, std::ios::trunc) << "base: &base\n  width: 12.\nroad: *base\n";
+            const cfg::ConfigBase base = cfg::GetConfig_From(t_config_path, options).value();
+            THEN("config value can be obtained")
+            {
+                REQUIRE(base.Get<double>("road.width").value() == 12.);
+            }
+        }
+        WHEN("a quoted scalar spans sections")
+        {
+            std::ofstream(t_config_path, std::ios::trunc) << "road:\n  name: 'main\nwidth: 12.'\nlength: 50.\n";
+            const cfg::ConfigBase base = cfg::GetConfig_From(t_config_path, options).value();
+            THEN("config value is the same as in the parsed config")
+            {
+                REQUIRE(base.Get<std::string>("road.name").value() == "main width: 12.");
+                REQUIRE(base.Get<double>("length").value() == 50.);
+            }
+        }
+        std::filesystem::remove(t_config_path);
+    }
+}
+
+SCENARIO("config values can be looked up in batches")
+{
+    GIVEN("config base apis obtained from valid file path, parsed, indexed, lazily parsed and compiled into an image")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::absolute("../../tests/test_config_basic.yaml");
+        const std::filesystem::path t_image_path = std::filesystem::temp_directory_path() / "cfg_test_batch.cfgc";
+        REQUIRE(cfg::CompileConfig(t_config_path, t_image_path));
+        cfg::LoadOptions indexed;
+        indexed.flat_index = true;
+        cfg::LoadOptions lazy;
+        lazy.lazy = true;
+        const std::vector<cfg::ConfigBase> bases = {cfg::GetConfig_From(t_config_path).value(),
+                                                    cfg::GetConfig_From(t_config_path, indexed).value(),
+                                                    cfg::GetConfig_From(t_config_path, lazy).value(),
+                                                    cfg::GetConfig_From(t_image_path).value()};
+        cfg::Batch batch;
+        const cfg::Slot<double> pi = batch.Add<double>("pi");
+        const cfg::Slot<double> length = batch.Add<double>("road.dims.length");
+        const cfg::Slot<double> width = batch.Add<double>("road.dims.width");
+        const cfg::Slot<double> hue = batch.Add<double>("road.color.hue");
+        const cfg::Slot<std::string> name = batch.Add<std::string>("attributes.name");
+        const cfg::Slot<cfg::Vec3D> point = batch.Add<cfg::Vec3D>("attributes.point");
+        const cfg::Slot<double> width_again = batch.Add<double>("road.dims.width");
+        const cfg::Slot<double> missing = batch.Add<double>("road.dims.invalid");
+        const cfg::Slot<double> beyond = batch.Add<double>("pi.invalid");
+        const cfg::Slot<double> mismatch = batch.Add<double>("attributes.name");
+        const cfg::Slot<cfg::Vec3I> malformed = batch.Add<cfg::Vec3I>("error.malformed");
+        const cfg::Slot<double> empty = batch.Add<double>("");
+        WHEN("a batch of keys is looked up")
+        {
+            THEN("values of all keys are obtained at once as by looking them up one by one")
+            {
+                const cfg::Vec3D e_point_xyz = {2.3, 5.2, 5.9};
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    const cfg::BatchResult result = base.Get(batch);
+                    REQUIRE(batch.Size() == 12);
+                    REQUIRE(result.Get(pi).value() == 3.14159);
+                    REQUIRE(result.Get(length).value() == 50.);
+                    REQUIRE(result.Get(width).value() == 12.);
+                    REQUIRE(result.Get(hue).value() == 0.2);
+                    REQUIRE(result.Get(name).value() == "some name");
+                    REQUIRE(result.Get(point).value() == e_point_xyz);
+                    REQUIRE(result.Get(width_again).value() == 12.);
+                    REQUIRE(result.Found(width_again));
+                }
+            }
+            THEN("missing keys are told apart from values, which cannot be decoded")
+            {
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    const cfg::BatchResult result = base.Get(batch);
+                    REQUIRE_FALSE(result.Get(missing).has_value());
+                    REQUIRE_FALSE(result.Found(missing));
+                    REQUIRE_FALSE(result.Get(beyond).has_value());
+                    REQUIRE_FALSE(result.Found(beyond));
+                    REQUIRE_FALSE(result.Get(empty).has_value());
+                    REQUIRE_FALSE(result.Found(empty));
+                    REQUIRE_FALSE(result.Get(mismatch).has_value());
+                    REQUIRE(result.Found(mismatch));
+                    REQUIRE_FALSE(result.Get(malformed).has_value());
+                    REQUIRE(result.Found(malformed));
+                }
+            }
+        }
+        std::filesystem::remove(t_image_path);
+    }
+}
+
+SCENARIO("structs can be bound to config using a schema")
+{
+    GIVEN("config base apis obtained from valid file path, parsed and compiled into an image")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::absolute("../../tests/test_config_basic.yaml");
+        const std::filesystem::path t_image_path = std::filesystem::temp_directory_path() / "cfg_test_schema.cfgc";
+        REQUIRE(cfg::CompileConfig(t_config_path, t_image_path));
+        const std::vector<cfg::ConfigBase> bases = {cfg::GetConfig_From(t_config_path).value(),
+                                                    cfg::GetConfig_From(t_image_path).value()};
+        WHEN("all keys of the schema are present")
+        {
+            THEN("all fields are filled at once")
+            {
+                const cfg::Vec3D e_point_xyz = {2.3, 5.2, 5.9};
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    app::Road road;
+                    REQUIRE(base.Bind(road).Ok());
+                    REQUIRE(road.length == 50.);
+                    REQUIRE(road.width == 12.);
+                    REQUIRE(road.hue == 0.2);
+                    REQUIRE(road.name == "some name");
+                    REQUIRE(road.point == e_point_xyz);
+                    REQUIRE(road.debug);
+                }
+            }
+        }
+        WHEN("keys of the schema are missing or values are mistyped")
+        {
+            THEN("all failures are reported together and their fields retain their values")
+            {
+                const std::vector<std::string> e_missing = {"road.dims.lanes"};
+                const std::vector<std::string> e_mistyped = {"attributes.name", "error.malformed"};
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    app::Broken broken;
+                    const cfg::BindReport report = base.Bind(broken);
+                    REQUIRE_FALSE(report.Ok());
+                    REQUIRE(report.missing == e_missing);
+                    REQUIRE(report.mistyped == e_mistyped);
+                    REQUIRE(broken.pi == 3.14159);
+                    REQUIRE(broken.lanes == 2.);
+                    REQUIRE(broken.name == 0.);
+                }
+            }
+        }
+        std::filesystem::remove(t_image_path);
+    }
+}
+
+SCENARIO("config values can be probed without exceptions or diagnostics")
+{
+    GIVEN("config base apis obtained from a config file, parsed and compiled into an image, and a diagnostics sink")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::temp_directory_path() / "cfg_test_try.yaml";
+        const std::filesystem::path t_image_path = std::filesystem::temp_directory_path() / "cfg_test_try.cfgc";
+        std::ofstream(t_config_path, std::ios::trunc) << "pi: 3.14159\n"
+                                                      << "name: some name\n"
+                                                      << "unset: ~\n"
+                                                      << "point: [2.3, 5.2, 5.9]\n"
+                                                      << "names: [tom, ~, harry]\n";
+        REQUIRE(cfg::CompileConfig(t_config_path, t_image_path));
+        cfg::LoadOptions indexed;
+        indexed.flat_index = true;
+        const std::vector<cfg::ConfigBase> bases = {cfg::GetConfig_From(t_config_path).value(),
+                                                    cfg::GetConfig_From(t_config_path, indexed).value(),
+                                                    cfg::GetConfig_From(t_image_path).value()};
+        std::vector<std::string> messages;
+        cfg::SetDiagnostics([&messages](std::string_view message)
+                            { messages.emplace_back(message); });
+        WHEN("values are probed")
+        {
+            THEN("values are obtained or the reason of the failure is told, without any diagnostics")
+            {
+                const cfg::Vec3Str e_names = {"tom", "null", "harry"};
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    REQUIRE(base.TryGet<double>("pi").value() == 3.14159);
+                    REQUIRE(base.TryGet<double>("pi").error() == cfg::Error::None);
+                    REQUIRE(base.TryGet<cfg::Vec3Str>("names").value() == e_names);
+                    REQUIRE(base.TryGet<double>("missing").error() == cfg::Error::Missing);
+                    REQUIRE(base.TryGet<double>("pi.missing").error() == cfg::Error::Missing);
+                    REQUIRE(base.TryGet<double>(base.Compile("missing")).error() == cfg::Error::Missing);
+                    REQUIRE(base.TryGet<std::string>("unset").error() == cfg::Error::Null);
+                    REQUIRE(base.TryGet<double>("name").error() == cfg::Error::TypeMismatch);
+                    REQUIRE(base.TryGet<cfg::Vec3D>("name").error() == cfg::Error::TypeMismatch);
+                    REQUIRE(base.TryGet<std::vector<int>>("point").error() == cfg::Error::TypeMismatch);
+                    REQUIRE(base.TryGet<cfg::Vec3I>("point").error() == cfg::Error::TypeMismatch);
+                    REQUIRE(base.TryGet<cfg::VecD<2>>("point").error() == cfg::Error::BadLength);
+                    REQUIRE(base.TryGet<cfg::VecD<2>>(base.Compile("point")).error() == cfg::Error::BadLength);
+                    REQUIRE(base.TryGet<double>("name").value_or(1.5) == 1.5);
+                }
+                REQUIRE(messages.empty());
+            }
+        }
+        WHEN("values, which cannot be decoded, are looked up")
+        {
+            THEN("failures are reported to the diagnostics sink, but missing and null values are not")
+            {
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    messages.clear();
+                    REQUIRE_FALSE(base.Get<double>("missing").has_value());
+                    REQUIRE_FALSE(base.Get<std::string>("unset").has_value());
+                    REQUIRE(messages.empty());
+                    REQUIRE_FALSE(base.Get<double>("name").has_value());
+                    REQUIRE_FALSE(base.Get<cfg::VecD<2>>(base.Compile("point")).has_value());
+                    REQUIRE(messages.size() == 2);
+                    REQUIRE(messages[0].find("name") != std::string::npos);
+                    REQUIRE(messages[1].find("point") != std::string::npos);
+                }
+            }
+        }
+        WHEN("config files cannot be read or are malformed")
+        {
+            std::ofstream(t_config_path, std::ios::trunc) << "road: [1, 2\n";
+            THEN("config cannot be obtained and the failure is reported to the diagnostics sink")
+            {
+                REQUIRE_FALSE(cfg::GetConfig_From(t_config_path).has_value());
+                REQUIRE_FALSE(cfg::GetConfig_From(t_config_path.string() + ".missing").has_value());
+                REQUIRE(messages.size() == 2);
+            }
+        }
+        cfg::SetDiagnostics([](std::string_view message)
+                            { std::cerr << message << '\n'; });
+        std::filesystem::remove(t_config_path);
+        std::filesystem::remove(t_image_path);
+    }
+}
+
+SCENARIO("config can be layered from multiple config files")
+{
+    GIVEN("a base config file and override files")
+    {
+        const std::filesystem::path t_dir = std::filesystem::temp_directory_path();
+        const std::filesystem::path t_base_path = t_dir / "cfg_test_layer_base.yaml";
+        const std::filesystem::path t_env_path = t_dir / "cfg_test_layer_env.yaml";
+        const std::filesystem::path t_host_path = t_dir / "cfg_test_layer_host.yaml";
+        const std::filesystem::path t_empty_path = t_dir / "cfg_test_layer_empty.yaml";
+        const std::filesystem::path t_image_path = t_dir / "cfg_test_layer_host.cfgc";
+        std::ofstream(t_base_path, std::ios::trunc) << "name: base\n"
+                                                    << "road:\n"
+                                                    << "  dims: {length: 50., width: 12.}\n"
+                                                    << "  lanes: [1, 2, 3]\n"
+                                                    << "  color: {hue: 0.2}\n"
+                                                    << "debug: true\n";
+        std::ofstream(t_env_path, std::ios::trunc) << "road:\n"
+                                                   << "  dims: {width: 14.}\n"
+                                                   << "  lanes: [4]\n"
+                                                   << "  color: red\n"
+                                                   << "debug: ~\n";
+        std::ofstream(t_host_path, std::ios::trunc) << "name: host\n"
+                                                    << "road:\n"
+                                                    << "  dims: {height: 5.1}\n";
+        std::ofstream(t_empty_path, std::ios::trunc) << "";
+        REQUIRE(cfg::CompileConfig(t_host_path, t_image_path));
+        WHEN("config files are layered")
+        {
+            cfg::LoadOptions indexed;
+            indexed.flat_index = true;
+            const std::vector<cfg::ConfigBase> bases = {
+                cfg::GetLayeredConfig_From({t_base_path, t_env_path, t_empty_path, t_host_path}).value(),
+                cfg::GetLayeredConfig_From({t_base_path, t_env_path, t_image_path}, indexed).value()};
+            THEN("maps are merged and any other value is taken from the last file having it")
+            {
+                const std::vector<int> e_lanes = {4};
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    REQUIRE(base.Get<std::string>("name").value() == "host");
+                    REQUIRE(base.Get<double>("road.dims.length").value() == 50.);
+                    REQUIRE(base.Get<double>("road.dims.width").value() == 14.);
+                    REQUIRE(base.Get<double>("road.dims.height").value() == 5.1);
+                    REQUIRE(base.Get<std::vector<int>>("road.lanes").value() == e_lanes);
+                    REQUIRE(base.Get<std::string>("road.color").value() == "red");
+                    REQUIRE_FALSE(base.Get<double>("road.color.hue").has_value());
+                    REQUIRE(base.TryGet<bool>("debug").error() == cfg::Error::Null);
+                }
+            }
+        }
+        WHEN("a single config file is layered")
+        {
+            const cfg::ConfigBase base = cfg::GetLayeredConfig_From({t_base_path}).value();
+            THEN("config is the same as the config file")
+            {
+                REQUIRE(base.Get<double>("road.dims.width").value() == 12.);
+                REQUIRE(base.Get<bool>("debug").value());
+            }
+        }
+        WHEN("any of the config files cannot be read or is malformed")
+        {
+            const std::filesystem::path t_malformed_path = t_dir / "cfg_test_layer_malformed.yaml";
+            std::ofstream(t_malformed_path, std::ios::trunc) << "road: [1, 2\n";
+            THEN("config cannot be obtained")
+            {
+                const std::filesystem::path t_missing_path = t_dir / "cfg_test_layer_missing.yaml";
+                REQUIRE_FALSE(cfg::GetLayeredConfig_From({t_base_path, t_missing_path}).has_value());
+                REQUIRE_FALSE(cfg::GetLayeredConfig_From({t_base_path, t_malformed_path}).has_value());
+                REQUIRE_FALSE(cfg::GetLayeredConfig_From({}).has_value());
+            }
+            std::filesystem::remove(t_malformed_path);
+        }
+        for (std::filesystem::path const &path : {t_base_path, t_env_path, t_host_path, t_empty_path, t_image_path})
+        {
+            std::filesystem::remove(path);
+        }
+    }
+}
+
+SCENARIO("config files can be shared across the process")
+{
+    GIVEN("the registry of shared configs enabled and a config file")
+    {
+        const std::filesystem::path t_dir = std::filesystem::temp_directory_path();
+        const std::filesystem::path t_config_path = t_dir / "cfg_test_shared.yaml";
+        std::ofstream(t_config_path, std::ios::trunc) << "road:\n  width: 12.\n";
+        cfg::SetSharedConfigCapacity(1 << 20);
+        const cfg::SharedConfigUsage initial = cfg::GetSharedConfigUsage();
+        WHEN("config file is loaded repeatedly under different paths")
+        {
+            const cfg::ConfigBase first = cfg::GetConfig_From(t_config_path).value();
+            const cfg::ConfigBase second = cfg::GetConfig_From(t_dir / "." / "cfg_test_shared.yaml").value();
+            THEN("config file is parsed once")
+            {
+                const cfg::SharedConfigUsage usage = cfg::GetSharedConfigUsage();
+                REQUIRE(usage.loads == initial.loads + 1);
+                REQUIRE(usage.hits == initial.hits + 1);
+                REQUIRE(usage.entries == 1);
+                REQUIRE(second.Get<double>("road.width").value() == 12.);
+            }
+        }
+        WHEN("config file is loaded with other load options")
+        {
+            cfg::LoadOptions indexed;
+            indexed.flat_index = true;
+            cfg::GetConfig_From(t_config_path).value();
+            const cfg::ConfigBase base = cfg::GetConfig_From(t_config_path, indexed).value();
+            THEN("config file is parsed for each of the load options")
+            {
+                REQUIRE(cfg::GetSharedConfigUsage().loads == initial.loads + 2);
+                REQUIRE(base.Get<double>("road.width").value() == 12.);
+            }
+        }
+        WHEN("config file changes after being loaded")
+        {
+            const cfg::ConfigBase stale = cfg::GetConfig_From(t_config_path).value();
+            std::ofstream(t_config_path, std::ios::trunc) << "road:\n  width: 24.\n  length: 50.\n";
+            const cfg::ConfigBase fresh = cfg::GetConfig_From(t_config_path).value();
+            THEN("config file is parsed again, while the stale config remains valid")
+            {
+                REQUIRE(cfg::GetSharedConfigUsage().loads == initial.loads + 2);
+                REQUIRE(cfg::GetSharedConfigUsage().entries == 1);
+                REQUIRE(stale.Get<double>("road.width").value() == 12.);
+                REQUIRE(fresh.Get<double>("road.width").value() == 24.);
+            }
+        }
+        WHEN("config file is loaded by many threads at the same time")
+        {
+            std::vector<std::thread> threads;
+            std::vector<int> failures(8, 0);
+            for (size_t idx = 0; idx < failures.size(); idx++)
+            {
+                threads.emplace_back([&t_config_path, &failures, idx]()
+                                     {
+                    boost::optional<cfg::ConfigBase> base = cfg::GetConfig_From(t_config_path);
+                    if (!base.has_value() || base->Get<double>("road.width").value_or(0.) != 12.)
+                    {
+                        failures[idx]++;
+                    } });
+            }
+            for (std::thread &thread : threads)
+            {
+                thread.join();
+            }
+            THEN("config file is parsed once")
+            {
+                for (int failure : failures)
+                {
+                    REQUIRE(failure == 0);
+                }
+                REQUIRE(cfg::GetSharedConfigUsage().loads == initial.loads + 1);
+            }
+        }
+        WHEN("config files exceed the capacity")
+        {
+            const std::filesystem::path t_other_path = t_dir / "cfg_test_shared_other.yaml";
+            std::ofstream(t_other_path, std::ios::trunc) << "road:\n  width: 14.\n";
+            cfg::GetConfig_From(t_config_path).value();
+            const uint64_t other_bytes = cfg::GetConfig_From(t_other_path).value().MemoryUsage().Total();
+            cfg::SetSharedConfigCapacity(other_bytes);
+            const cfg::SharedConfigUsage usage = cfg::GetSharedConfigUsage();
+            const cfg::ConfigBase base = cfg::GetConfig_From(t_config_path).value();
+            THEN("least recently loaded configs are evicted, as their memory footprint exceeds the capacity")
+            {
+                REQUIRE(other_bytes > std::filesystem::file_size(t_other_path));
+                REQUIRE(usage.entries == 1);
+                REQUIRE(usage.bytes == other_bytes);
+                REQUIRE(cfg::GetSharedConfigUsage().loads == initial.loads + 3);
+                REQUIRE(base.Get<double>("road.width").value() == 12.);
+            }
+            std::filesystem::remove(t_other_path);
+        }
+        WHEN("the registry is disabled")
+        {
+            cfg::GetConfig_From(t_config_path).value();
+            cfg::SetSharedConfigCapacity(0);
+            cfg::GetConfig_From(t_config_path).value();
+            THEN("configs are neither held nor shared")
+            {
+                REQUIRE(cfg::GetSharedConfigUsage().entries == 0);
+                REQUIRE(cfg::GetSharedConfigUsage().loads == initial.loads + 1);
+            }
+        }
+        WHEN("config file cannot be read")
+        {
+            THEN("config cannot be obtained and nothing is held")
+            {
+                REQUIRE_FALSE(cfg::GetConfig_From(t_dir / "cfg_test_shared_missing.yaml").has_value());
+                REQUIRE(cfg::GetSharedConfigUsage().entries == 0);
+            }
+        }
+        cfg::SetSharedConfigCapacity(0);
+        std::filesystem::remove(t_config_path);
+    }
+}
+
+SCENARIO("config can be loaded asynchronously")
+{
+    GIVEN("config files, of which one cannot be read and one is malformed")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::absolute("../../tests/test_config_basic.yaml");
+        const std::filesystem::path t_invalid_path = std::filesystem::absolute("../../tests/invalid_file.yaml");
+        const std::filesystem::path t_malformed_path = std::filesystem::temp_directory_path() / "cfg_test_async.yaml";
+        std::ofstream(t_malformed_path, std::ios::trunc) << "road: [1, 2\n";
+        WHEN("config files are loaded in the background")
+        {
+            std::future<boost::optional<cfg::ConfigBase>> valid = cfg::GetConfig_FromAsync(t_config_path);
+            std::future<boost::optional<cfg::ConfigBase>> invalid = cfg::GetConfig_FromAsync(t_invalid_path);
+            std::future<boost::optional<cfg::ConfigBase>> malformed = cfg::GetConfig_FromAsync(t_malformed_path);
+            THEN("configs are obtained like loading them synchronously")
+            {
+                const boost::optional<cfg::ConfigBase> base = valid.get();
+                REQUIRE(base.has_value());
+                REQUIRE(base->Get<double>("pi").value() == 3.14159);
+                REQUIRE_FALSE(invalid.get().has_value());
+                REQUIRE_FALSE(malformed.get().has_value());
+            }
+        }
+        WHEN("config files are loaded at once")
+        {
+            cfg::LoadOptions options;
+            options.native = true;
+            const std::vector<boost::optional<cfg::ConfigBase>> bases =
+                cfg::GetConfigs_From({t_config_path, t_invalid_path, t_config_path, t_malformed_path}, options);
+            THEN("configs are obtained in the given order")
+            {
+                REQUIRE(bases.size() == 4);
+                REQUIRE(bases[0].has_value());
+                REQUIRE_FALSE(bases[1].has_value());
+                REQUIRE(bases[2].has_value());
+                REQUIRE_FALSE(bases[3].has_value());
+                REQUIRE(bases[2]->Get<std::string>("attributes.name").value() == "some name");
+                REQUIRE(cfg::GetConfigs_From({}).empty());
+            }
+        }
+        std::filesystem::remove(t_malformed_path);
+    }
+}
+
+SCENARIO("config keys can be enumerated underneath a prefix")
+{
+    GIVEN("a config file loaded with every backend")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::absolute("../../tests/test_config_basic.yaml");
+        const std::filesystem::path t_image_path = std::filesystem::temp_directory_path() / "cfg_test_keys.cfgc";
+        REQUIRE(cfg::CompileConfig(t_config_path, t_image_path));
+        std::vector<cfg::LoadOptions> options(4);
+        options[1].flat_index = true;
+        options[2].lazy = true;
+        options[3].native = true;
+        std::vector<cfg::ConfigBase> bases;
+        for (cfg::LoadOptions const &option : options)
+        {
+            bases.push_back(cfg::GetConfig_From(t_config_path, option).value());
+        }
+        bases.push_back(cfg::GetConfig_From(t_image_path).value());
+        WHEN("keys underneath a section are enumerated")
+        {
+            const std::vector<std::string> e_road = {"road.dims.length", "road.dims.width", "road.dims.height",
+                                                     "road.color.hue", "road.color.saturation", "road.color.value"};
+            THEN("combined keys of all values in the section are obtained in document order")
+            {
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    REQUIRE(base.Keys("road") == e_road);
+                    REQUIRE(base.Keys("road.dims.width") == std::vector<std::string>{"road.dims.width"});
+                    REQUIRE(base.Keys("pi") == std::vector<std::string>{"pi"});
+                    REQUIRE(base.Keys("road.missing").empty());
+                    REQUIRE(base.Keys("pi.missing").empty());
+                    REQUIRE(base.Keys().size() == 13);
+                    REQUIRE(base.Keys().front() == "pi");
+                    REQUIRE(base.Keys().back() == "error.malformed");
+                }
+            }
+        }
+        WHEN("values underneath a section are visited")
+        {
+            THEN("typed values are obtained along with their keys")
+            {
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    double sum = 0.;
+                    const auto add = [&sum](std::string_view key, cfg::ConfigValue const &value)
+                    {
+                        REQUIRE(key.substr(0, 11) == "road.color.");
+                        REQUIRE_FALSE(value.IsSequence());
+                        sum += value.Get<double>().value();
+                    };
+                    const size_t count = base.ForEach("road.color", add);
+                    REQUIRE(count == 3);
+                    REQUIRE(sum == 0.2 + 0.2 + 0.2);
+                    std::vector<std::string> sequences;
+                    base.ForEach("attributes", [&sequences](std::string_view key, cfg::ConfigValue const &value)
+                                 {
+                        if (value.IsSequence())
+                        {
+                            sequences.emplace_back(key);
+                        } });
+                    const std::vector<std::string> e_sequences = {"attributes.point", "attributes.rgb",
+                                                                  "attributes.names"};
+                    REQUIRE(sequences == e_sequences);
+                    base.ForEach("attributes.point", [](std::string_view, cfg::ConfigValue const &value)
+                                 { REQUIRE(value.Get<cfg::Vec3D>().value() == cfg::Vec3D{2.3, 5.2, 5.9}); });
+                    REQUIRE(base.ForEach("error", [](std::string_view, cfg::ConfigValue const &value)
+                                         { REQUIRE_FALSE(value.TryGet<cfg::Vec3I>().has_value()); }) == 1);
+                }
+            }
+        }
+        std::filesystem::remove(t_image_path);
+    }
+}
@@ -88,4 +88,27 @@ SCENARIO("custom types can be used with sequence configurations")
             }
         }
     }
-}
\ No newline at end of file
+}
+
+SCENARIO("vector types are fixed size value types")
+{
+    GIVEN("vectors constructed at compile time")
+    {
+        constexpr cfg::Vec3D origin = {0., 0., 0.};
+        constexpr cfg::Vec3D unit_x = {1., 0., 0.};
+        static_assert(origin != unit_x && origin == cfg::Vec3D() && unit_x[0] == 1.);
+        THEN("vectors store their elements inline")
+        {
+            REQUIRE(sizeof(cfg::Vec3D) == 32);
+            REQUIRE(sizeof(Vec3U8) == 4);
+            REQUIRE(cfg::Vec3D::size() == 3);
+            REQUIRE(unit_x.data()[0] == 1.);
+        }
+        THEN("vectors can be compared")
+        {
+            const Vec3U8 e_rgb = {255, 255, 255};
+            REQUIRE(e_rgb != Vec3U8());
+            REQUIRE_FALSE(e_rgb != Vec3U8({255, 255, 255}));
+        }
+    }
+}
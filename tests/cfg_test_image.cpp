@@ -0,0 +1,392 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "cfg.hpp"
+#include "image.hpp"
+#include "native.hpp"
+#include "types.hpp"
+
+/// @brief Checks that a config value is obtained identically from the parsed config file and the compiled image
+template <typename T>
+bool SameValue(cfg::ConfigBase const &parsed, cfg::ConfigBase const &compiled, std::string const &key)
+{
+    return parsed.Get<T>(key) == compiled.Get<T>(key) && parsed.Get<T>(compiled.Compile(key)) == compiled.Get<T>(key);
+}
+
+SCENARIO("config can be read from a compiled config image")
+{
+    GIVEN("a config base api obtained from a config file compiled into an image")
+    {
+        // Path to config file needs to be adjusted keeping in mind that when we execute test from build dir
+        // that would be the context of the executable binary.
+        const std::filesystem::path t_config_path = std::filesystem::absolute("../../tests/test_config_basic.yaml");
+        const std::filesystem::path t_image_path = std::filesystem::temp_directory_path() / "cfg_test_basic.cfgc";
+        REQUIRE(cfg::CompileConfig(t_config_path, t_image_path));
+        const cfg::ConfigBase parsed = cfg::GetConfig_From(t_config_path).value();
+        const cfg::ConfigBase compiled = cfg::GetConfig_From(t_image_path).value();
+        WHEN("valid key is used")
+        {
+            THEN("config value is the same as in the config file")
+            {
+                const cfg::Vec3D e_point_xyz = {2.3, 5.2, 5.9};
+                const cfg::Vec3I e_rgb = {255, 255, 255};
+                const cfg::Vec3Str e_names = {"tom", "dick", "harry"};
+                REQUIRE(compiled.Get<double>("pi").value() == 3.14159);
+                REQUIRE(compiled.Get<std::string>("attributes.name").value() == "some name");
+                REQUIRE(compiled.Get<bool>("attributes.debug").value());
+                REQUIRE(compiled.Get<cfg::Vec3D>("attributes.point").value() == e_point_xyz);
+                REQUIRE(compiled.Get<cfg::Vec3I>("attributes.rgb").value() == e_rgb);
+                REQUIRE(compiled.Get<cfg::Vec3Str>("attributes.names").value() == e_names);
+                REQUIRE(compiled.Get<double>("road.dims.height").value() == 5.1);
+                REQUIRE(compiled.Get<double>(compiled.Compile("road.color.value")).value() == 0.2);
+            }
+        }
+        WHEN("invalid or malformed key is used")
+        {
+            THEN("config value cannot be obtained")
+            {
+                REQUIRE_FALSE(compiled.Get<double>("").has_value());
+                REQUIRE_FALSE(compiled.Get<double>("road.color.invalid").has_value());
+                REQUIRE_FALSE(compiled.Get<double>("road.color").has_value());
+                REQUIRE_FALSE(compiled.Get<int>("road.dims.width").has_value());
+                REQUIRE_FALSE(compiled.Get<cfg::Vec3I>("error.malformed").has_value());
+                REQUIRE_FALSE(compiled.Get<double>(compiled.Compile("pi.invalid")).has_value());
+            }
+        }
+        WHEN("a handle compiled by the parsed config is used")
+        {
+            const cfg::Key ROAD_DIMS_WIDTH = parsed.Compile("road.dims.width");
+            THEN("config value is obtained from the image")
+            {
+                REQUIRE(compiled.Get<double>(ROAD_DIMS_WIDTH).value() == 12.);
+                REQUIRE(compiled.Cached<double>(ROAD_DIMS_WIDTH).value() == 12.);
+            }
+        }
+        std::filesystem::remove(t_image_path);
+    }
+}
+
+SCENARIO("compiled config images decode values like the config file")
+{
+    GIVEN("a config file with edge case values compiled into an image")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::temp_directory_path() / "cfg_test_edge.yaml";
+        const std::filesystem::path t_image_path = std::filesystem::temp_directory_path() / "cfg_test_edge.cfgc";
+        std::ofstream(t_config_path, std::ios::trunc) << "octal: 010\n"
+                                                      << "hex: 0x1F\n"
+                                                      << "negative: -1\n"
+                                                      << "zero: -0\n"
+                                                      << "large: 300\n"
+                                                      << "huge: 18446744073709551615\n"
+                                                      << "fraction: 1.5\n"
+                                                      << "infinite: -.inf\n"
+                                                      << "flag: yes\n"
+                                                      << "quoted: 'null'\n"
+                                                      << "empty:\n"
+                                                      << "dotted.key: 1\n"
+                                                      << "nested: {list: [1, 2, 3], words: [a, b]}\n";
+        REQUIRE(cfg::CompileConfig(t_config_path, t_image_path));
+        const cfg::ConfigBase parsed = cfg::GetConfig_From(t_config_path).value();
+        const cfg::ConfigBase compiled = cfg::GetConfig_From(t_image_path).value();
+        WHEN("values are looked up with various types")
+        {
+            const std::vector<std::string> keys = {"octal", "hex", "negative", "zero", "large", "huge",
+                                                   "fraction", "infinite", "flag", "quoted", "empty", "dotted.key",
+                                                   "nested", "nested.list", "nested.words", "missing"};
+            THEN("config values and failures are the same as in the config file")
+            {
+                for (std::string const &key : keys)
+                {
+                    INFO(key);
+                    REQUIRE(SameValue<int>(parsed, compiled, key));
+                    REQUIRE(SameValue<int8_t>(parsed, compiled, key));
+                    REQUIRE(SameValue<uint8_t>(parsed, compiled, key));
+                    REQUIRE(SameValue<unsigned>(parsed, compiled, key));
+                    REQUIRE(SameValue<uint64_t>(parsed, compiled, key));
+                    REQUIRE(SameValue<float>(parsed, compiled, key));
+                    REQUIRE(SameValue<double>(parsed, compiled, key));
+                    REQUIRE(SameValue<bool>(parsed, compiled, key));
+                    REQUIRE(SameValue<std::string>(parsed, compiled, key));
+                    REQUIRE(SameValue<std::vector<int>>(parsed, compiled, key));
+                    REQUIRE(SameValue<std::vector<std::string>>(parsed, compiled, key));
+                }
+            }
+        }
+        std::filesystem::remove(t_config_path);
+        std::filesystem::remove(t_image_path);
+    }
+}
+
+SCENARIO("corrupted compiled config images are rejected")
+{
+    GIVEN("a compiled config image")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::absolute("../../tests/test_config_basic.yaml");
+        const std::filesystem::path t_image_path = std::filesystem::temp_directory_path() / "cfg_test_corrupt.cfgc";
+        REQUIRE(cfg::CompileConfig(t_config_path, t_image_path));
+        std::ifstream in(t_image_path, std::ios::binary);
+        const std::vector<char> image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        WHEN("the image is truncated")
+        {
+            std::ofstream(t_image_path, std::ios::binary | std::ios::trunc).write(image.data(), image.size() / 2);
+            THEN("config base api cannot be obtained")
+            {
+                REQUIRE_FALSE(cfg::GetConfig_From(t_image_path).has_value());
+            }
+        }
+        WHEN("the image has an unknown format version")
+        {
+            std::vector<char> corrupted = image;
+            corrupted[offsetof(cfg::detail::ImageHeader, version)] ^= 0x7F;
+            std::ofstream(t_image_path, std::ios::binary | std::ios::trunc).write(corrupted.data(), corrupted.size());
+            THEN("config base api cannot be obtained")
+            {
+                REQUIRE_FALSE(cfg::GetConfig_From(t_image_path).has_value());
+            }
+        }
+        cfg::detail::ImageHeader header;
+        std::memcpy(&header, image.data(), sizeof(header));
+        WHEN("the root node of an image with a valid header refers to itself as its first child")
+        {
+            std::vector<char> corrupted = image;
+            const uint32_t root = 0;
+            std::memcpy(corrupted.data() + header.nodes_offset + offsetof(cfg::detail::ImageNode, value), &root,
+                        sizeof(root));
+            std::ofstream(t_image_path, std::ios::binary | std::ios::trunc).write(corrupted.data(), corrupted.size());
+            THEN("the image cannot be mapped")
+            {
+                REQUIRE(cfg::detail::Image::Map(t_image_path) == nullptr);
+                REQUIRE_FALSE(cfg::GetConfig_From(t_image_path).has_value());
+            }
+        }
+        WHEN("a string of an image with a valid header lies outside of the string characters")
+        {
+            std::vector<char> corrupted = image;
+            const uint64_t offset = header.blob_size;
+            std::memcpy(corrupted.data() + header.strings_offset + offsetof(cfg::detail::ImageString, offset), &offset,
+                        sizeof(offset));
+            std::ofstream(t_image_path, std::ios::binary | std::ios::trunc).write(corrupted.data(), corrupted.size());
+            THEN("the image cannot be mapped")
+            {
+                REQUIRE(cfg::detail::Image::Map(t_image_path) == nullptr);
+                REQUIRE_FALSE(cfg::GetConfig_From(t_image_path).has_value());
+            }
+        }
+        WHEN("a key of an image with a valid header refers to a node beyond the node table")
+        {
+            std::vector<char> corrupted = image;
+            const uint32_t node = static_cast<uint32_t>(header.node_count);
+            std::memcpy(corrupted.data() + header.keys_offset + offsetof(cfg::detail::ImageKey, node), &node,
+                        sizeof(node));
+            std::ofstream(t_image_path, std::ios::binary | std::ios::trunc).write(corrupted.data(), corrupted.size());
+            THEN("the image cannot be mapped")
+            {
+                REQUIRE(cfg::detail::Image::Map(t_image_path) == nullptr);
+                REQUIRE_FALSE(cfg::GetConfig_From(t_image_path).has_value());
+            }
+        }
+        std::filesystem::remove(t_image_path);
+    }
+}
+
+/// @brief Generates a random config document of the subset, which the native parser supports, recording the
+/// combined keys of its values
+std::string GenerateNative(std::mt19937 &rng, std::string const &prefix, int indent, int depth,
+                           std::vector<std::string> &keys)
+{
+    static const std::vector<std::string> scalars = {
+        "0", "-7", "010", "0x1F", "255", "256", "18446744073709551615", "1.5", "-.5", "1e3", ".inf", "yes", "Off",
+        "true", "~", "null", "", "word", "two words", "'quoted'", "'it''s'", "\"esc\\t\\u00e9\"", "[1, 2, 3]",
+        "[1.5, -2, 3e2]", "[a, 'b', \"c\"]", "{x: 1, y: [2]}", "[]", "{}", "TRUE", "tRUE", "nO", "No"};
+    std::string doc;
+    const int entries = 1 + static_cast<int>(rng() % 4);
+    for (int entry = 0; entry < entries; entry++)
+    {
+        // Keys are drawn from a small set, so that duplicate keys occur as well
+        const std::string key = "k" + std::to_string(rng() % 5);
+        keys.push_back(prefix + key);
+        doc += std::string(indent, ' ') + key + ":";
+        switch (depth > 0 ? rng() % 4 : 0)
+        {
+        case 1:
+            doc += " # nested map\n" + GenerateNative(rng, prefix + key + ".", indent + 2, depth - 1, keys);
+            break;
+        case 2:
+            doc += "\n";
+            for (int item = 0; item < 3; item++)
+            {
+                doc += std::string(indent, ' ') + "- " + scalars[rng() % 18] + "\n";
+            }
+            break;
+        default:
+            doc += " " + scalars[rng() % scalars.size()] + "\n";
+            break;
+        }
+    }
+    return doc;
+}
+
+/// @brief Checks that a natively parsed config file yields the same config values as the one parsed by yaml-cpp
+bool SameNative(cfg::ConfigBase const &parsed, cfg::ConfigBase const &native, std::string const &key)
+{
+    return SameValue<int>(parsed, native, key) && SameValue<int64_t>(parsed, native, key) &&
+           SameValue<unsigned>(parsed, native, key) && SameValue<double>(parsed, native, key) &&
+           SameValue<bool>(parsed, native, key) && SameValue<std::string>(parsed, native, key) &&
+           SameValue<std::vector<int>>(parsed, native, key) && SameValue<std::vector<double>>(parsed, native, key) &&
+           SameValue<std::vector<std::string>>(parsed, native, key) && SameValue<cfg::Vec3D>(parsed, native, key) &&
+           SameValue<cfg::Vec3Str>(parsed, native, key);
+}
+
+SCENARIO("config files of the common subset of YAML are parsed natively")
+{
+    GIVEN("config files within and beyond the subset")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::temp_directory_path() / "cfg_test_native.yaml";
+        cfg::LoadOptions options;
+        options.native = true;
+        const std::vector<std::string> supported = {
+            "a: 1\nb:\n  c: [1, 2, 3]\n  d: {x: 1.5, y: -2}\n",
+            "# comment\n---\nlist:\n- 1\n- two\n-\n- - 3\n  - 4\n- k: v\n  l: [w]\n",
+            "quoted: 'it''s'\ndouble: \"tab\\tnew\\nline \\u00e9 \\x41 \\\\ \\\"\"\nempty: ''\nnull1: ~\nnull2: null\n"
+            "null3:\nstr_null: 'null'\n",
+            "flow: [a, 'b, c', \"d\",\n  {e: f}, [g]]\nmap: {a: 1,\n  b: 2,}\n",
+            "dup: 1\ndup: 2\nnested:\n  dup: [1]\n  dup: x\n",
+            "bools: [yes, No, TRUE, off, y, n]\nnums: [010, 0x1F, -0, 1e3, .inf, -.nan, 18446744073709551615]\n",
+            "key with spaces : value with  spaces # comment\nurl: http://x.y/z?a=b#frag\ncolon: a:b\n",
+            "seq:\n  - a\n  - b\nsame_indent:\n- c\n- d\nafter: 1\n",
+            "[1, 2, 3]\n"};
+        const std::vector<std::string> unsupported = {
+            "a: &x 1\nb: *x\n", "a: !!str 1\n", "a: |\n  text\n", "a: >\n  text\n", "a: multi\n  line\n",
+            "? a\n: 1\n", "a: 1\n---\nb: 2\n", "a:\t1\n", "base: {a: 1}\nderived:\n  <<: {b: 2}\n",
+            "a: 'multi\n  line'\n", "a: 1\r\n", "a: b: c\n", "a: [1, 2\n", "a: [b?c]\n", "a: {b: c?}\n"};
+        WHEN("config files within the subset are loaded")
+        {
+            THEN("they are parsed natively and yield the same config values as parsed by yaml-cpp")
+            {
+                for (std::string const &doc : supported)
+                {
+                    INFO(doc);
+                    cfg::detail::NativeTree tree;
+                    REQUIRE(cfg::detail::ParseNative(doc, tree));
+                    std::ofstream(t_config_path, std::ios::trunc) << doc;
+                    const cfg::ConfigBase parsed = cfg::GetConfig_From(t_config_path).value();
+                    const cfg::ConfigBase native = cfg::GetConfig_From(t_config_path, options).value();
+                    REQUIRE(parsed.Diff(native).Empty());
+                    for (char const *key : {"a", "b.c", "b.d", "list", "double", "null1", "null3", "str_null", "flow",
+                                            "map.b", "dup", "nested.dup", "bools", "nums", "url", "key with spaces",
+                                            "colon", "same_indent", "after", "missing"})
+                    {
+                        INFO(key);
+                        REQUIRE(SameNative(parsed, native, key));
+                    }
+                }
+            }
+        }
+        WHEN("config files beyond the subset are loaded")
+        {
+            THEN("they are rejected by the native parser and parsed by yaml-cpp instead")
+            {
+                for (std::string const &doc : unsupported)
+                {
+                    INFO(doc);
+                    cfg::detail::NativeTree tree;
+                    REQUIRE_FALSE(cfg::detail::ParseNative(doc, tree));
+                    std::ofstream(t_config_path, std::ios::trunc) << doc;
+                    const boost::optional<cfg::ConfigBase> parsed = cfg::GetConfig_From(t_config_path);
+                    const boost::optional<cfg::ConfigBase> native = cfg::GetConfig_From(t_config_path, options);
+                    REQUIRE(parsed.has_value() == native.has_value());
+                    if (parsed.has_value())
+                    {
+                        REQUIRE(parsed->Diff(native.value()).Empty());
+                    }
+                }
+            }
+        }
+        WHEN("randomly generated config files of the subset are loaded")
+        {
+            std::mt19937 rng(42);
+            THEN("they yield the same config values as parsed by yaml-cpp")
+            {
+                for (int round = 0; round < 100; round++)
+                {
+                    std::vector<std::string> keys;
+                    const std::string doc = GenerateNative(rng, "", 0, 3, keys);
+                    INFO(doc);
+                    cfg::detail::NativeTree tree;
+                    REQUIRE(cfg::detail::ParseNative(doc, tree));
+                    std::ofstream(t_config_path, std::ios::trunc) << doc;
+                    const cfg::ConfigBase parsed = cfg::GetConfig_From(t_config_path).value();
+                    const cfg::ConfigBase native = cfg::GetConfig_From(t_config_path, options).value();
+                    REQUIRE(parsed.Diff(native).Empty());
+                    for (std::string const &key : keys)
+                    {
+                        INFO(key);
+                        REQUIRE(SameNative(parsed, native, key));
+                    }
+                }
+            }
+        }
+        std::filesystem::remove(t_config_path);
+    }
+}
+
+SCENARIO("configs can be stored compactly with interned strings")
+{
+    GIVEN("config files within and beyond the subset of the native parser, loaded compactly")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::absolute("../../tests/test_config_basic.yaml");
+        const std::filesystem::path t_anchors_path = std::filesystem::temp_directory_path() / "cfg_test_compact.yaml";
+        std::ofstream(t_anchors_path, std::ios::trunc) << "base: &b {mode: enabled}\nderived: *b\n";
+        cfg::LoadOptions options;
+        options.compact = true;
+        const cfg::ConfigBase parsed = cfg::GetConfig_From(t_config_path).value();
+        const cfg::ConfigBase compact = cfg::GetConfig_From(t_config_path, options).value();
+        const cfg::ConfigBase anchors = cfg::GetConfig_From(t_anchors_path, options).value();
+        WHEN("values are looked up")
+        {
+            THEN("they are the same as in the node tree")
+            {
+                REQUIRE(parsed.Diff(compact).Empty());
+                REQUIRE(SameValue<std::string>(parsed, compact, "attributes.name"));
+                REQUIRE(SameValue<cfg::Vec3Str>(parsed, compact, "attributes.names"));
+                REQUIRE(SameValue<double>(parsed, compact, "road.dims.height"));
+                REQUIRE(anchors.Get<std::string>("derived.mode").value() == "enabled");
+            }
+        }
+        WHEN("string values are looked up as views")
+        {
+            const boost::optional<std::string_view> name = compact.Get<std::string_view>("attributes.name");
+            THEN("they refer to the interned strings without copying")
+            {
+                REQUIRE(name.value() == "some name");
+                REQUIRE(compact.Get<std::string_view>("attributes.name")->data() == name->data());
+                REQUIRE(parsed.Get<std::string_view>("attributes.name").value() == "some name");
+                REQUIRE_FALSE(compact.Get<std::string_view>("attributes.names").has_value());
+                REQUIRE_FALSE(parsed.Get<std::string_view>("attributes.names").has_value());
+                REQUIRE_FALSE(compact.Get<std::string_view>("attributes.missing").has_value());
+            }
+        }
+        WHEN("the memory usage is reported")
+        {
+            const cfg::ConfigMemoryUsage compact_usage = compact.MemoryUsage();
+            const cfg::ConfigMemoryUsage parsed_usage = parsed.MemoryUsage();
+            THEN("the footprint of the compact config is exact and smaller than the footprint of the node tree")
+            {
+                REQUIRE(compact_usage.exact);
+                REQUIRE_FALSE(parsed_usage.exact);
+                REQUIRE(compact_usage.Total() == cfg::detail::LoadNative(t_config_path)->Size());
+                REQUIRE(compact_usage.Total() < parsed_usage.Total());
+                REQUIRE(compact_usage.strings > 0);
+            }
+        }
+        std::filesystem::remove(t_anchors_path);
+    }
+}
@@ -0,0 +1,125 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "cfg.hpp"
+#include "image.hpp"
+#include "numeric.hpp"
+#include "types.hpp"
+
+/// @brief Checks that a scalar is parsed into the same number, or rejected alike, as yaml-cpp would
+template <typename T>
+bool SameNumber(std::string const &text)
+{
+    T expected{};
+    T actual{};
+    const bool e_ok = YAML::convert<T>::decode(YAML::Node(text), expected);
+    const bool ok = cfg::detail::ParseNumber(text, actual);
+    // NaN compares unequal to itself
+    return ok == e_ok && (!ok || actual == expected || (actual != actual && expected != expected));
+}
+
+SCENARIO("numbers are parsed like yaml-cpp parses them")
+{
+    GIVEN("scalars in various notations")
+    {
+        const std::vector<std::string> scalars = {
+            "0", "-0", "7", "-7", "+7", "010", "-010", "0x1F", "0X1f", "08", "255", "256", "-128", "-129",
+            "2147483647", "2147483648", "-2147483648", "18446744073709551615", "18446744073709551616", "1.5",
+            "-1.5", ".5", "-.5", "5.", "1e3", "1E-3", "1e+3", "1e", "1e400", "-1e400", "1e-400", "3.14159",
+            "0.1", "2.2250738585072014e-308", ".inf", "-.inf", ".nan", "inf", "nan", "1_000", "1,5", "12abc",
+            "", "-", ".", " 1", "1 ", "true"};
+        THEN("results are the same for all number types")
+        {
+            for (std::string const &text : scalars)
+            {
+                INFO(text);
+                REQUIRE(SameNumber<int>(text));
+                REQUIRE(SameNumber<int8_t>(text));
+                REQUIRE(SameNumber<uint8_t>(text));
+                REQUIRE(SameNumber<int64_t>(text));
+                REQUIRE(SameNumber<uint64_t>(text));
+                REQUIRE(SameNumber<unsigned>(text));
+                REQUIRE(SameNumber<float>(text));
+                REQUIRE(SameNumber<double>(text));
+            }
+        }
+    }
+}
+
+SCENARIO("numeric arrays and matrices can be read")
+{
+    GIVEN("a config file with numeric tables, parsed and compiled into an image")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::temp_directory_path() / "cfg_test_numeric.yaml";
+        const std::filesystem::path t_image_path = std::filesystem::temp_directory_path() / "cfg_test_numeric.cfgc";
+        std::ofstream(t_config_path, std::ios::trunc) << "tables:\n"
+                                                      << "  curve: [0.5, 1, -2.25, 1e3, .inf]\n"
+                                                      << "  counts: [1, 010, 0x10, -3]\n"
+                                                      << "  empty: []\n"
+                                                      << "  mixed: [1, two, 3]\n"
+                                                      << "  calibration: [[1, 0, 0.5], [0, 1, -0.5]]\n"
+                                                      << "  ragged: [[1, 2], [3]]\n";
+        REQUIRE(cfg::CompileConfig(t_config_path, t_image_path));
+        const std::vector<cfg::ConfigBase> bases = {cfg::GetConfig_From(t_config_path).value(),
+                                                    cfg::GetConfig_From(t_image_path).value()};
+        WHEN("sequences of numbers are looked up")
+        {
+            THEN("contiguous buffers of any length are obtained")
+            {
+                const std::vector<double> e_curve = {0.5, 1., -2.25, 1e3, std::numeric_limits<double>::infinity()};
+                const std::vector<int> e_counts = {1, 8, 16, -3};
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    REQUIRE(base.GetArray<double>("tables.curve").value() == e_curve);
+                    REQUIRE(base.GetArray<double>(base.Compile("tables.curve")).value() == e_curve);
+                    REQUIRE(base.GetArray<int>("tables.counts").value() == e_counts);
+                    REQUIRE(base.GetArray<float>("tables.curve").value().size() == 5);
+                    REQUIRE(base.GetArray<double>("tables.empty").value().empty());
+                    REQUIRE(base.Cached<std::vector<double>>("tables.curve").value() == e_curve);
+                }
+            }
+            THEN("sequences with non-numbers or values out of range cannot be obtained")
+            {
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    REQUIRE_FALSE(base.GetArray<double>("tables.mixed").has_value());
+                    REQUIRE_FALSE(base.GetArray<int>("tables.curve").has_value());
+                    REQUIRE_FALSE(base.GetArray<uint8_t>("tables.counts").has_value());
+                    REQUIRE_FALSE(base.GetArray<double>("tables.calibration").has_value());
+                    REQUIRE_FALSE(base.GetArray<double>("tables.missing").has_value());
+                }
+            }
+        }
+        WHEN("tables of numbers are looked up")
+        {
+            THEN("matrices are obtained in row-major order")
+            {
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    const cfg::Matrix<double> calibration = base.GetMatrix<double>("tables.calibration").value();
+                    REQUIRE(calibration.rows() == 2);
+                    REQUIRE(calibration.cols() == 3);
+                    REQUIRE(calibration(0, 2) == 0.5);
+                    REQUIRE(calibration(1, 2) == -0.5);
+                    REQUIRE(calibration.data()[4] == 1.);
+                }
+            }
+            THEN("ragged tables cannot be obtained")
+            {
+                for (cfg::ConfigBase const &base : bases)
+                {
+                    REQUIRE_FALSE(base.GetMatrix<double>("tables.ragged").has_value());
+                    REQUIRE_FALSE(base.GetMatrix<double>("tables.curve").has_value());
+                }
+            }
+        }
+        std::filesystem::remove(t_config_path);
+        std::filesystem::remove(t_image_path);
+    }
+}
@@ -0,0 +1,596 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "published.hpp"
+#include "rcu.hpp"
+#include "reload.hpp"
+#include "types.hpp"
+#include "writable.hpp"
+
+#ifdef __unix__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /// @brief Atomically replaces the config file with a version, in which every value is derived from the version
+    void WriteVersion(std::filesystem::path const &path, int version)
+    {
+        const std::filesystem::path tmp_path = path.string() + ".tmp";
+        {
+            std::ofstream out(tmp_path, std::ios::trunc);
+            out << "version: " << version << '\n';
+            out << "road:\n";
+            out << "  dims:\n";
+            out << "    width: " << version * 2 << '\n';
+            out << "    length: " << version * 3 << '\n';
+        }
+        std::filesystem::rename(tmp_path, path);
+    }
+
+    /// @brief Reads the whole text of a file
+    std::string ReadText(std::filesystem::path const &path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+
+    /// @brief Waits until the predicate holds or a timeout elapses
+    template <typename Pred>
+    bool WaitFor(Pred &&pred)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!pred())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    constexpr uint64_t ALIVE = 0xa11fe; // State of values, which are not reclaimed yet
+
+    /// @brief Value, which marks itself as reclaimed, such that readers of reclaimed values are detected also
+    /// without a sanitizer
+    struct Value
+    {
+        std::atomic<uint64_t> state{ALIVE};
+        uint64_t version;
+        explicit Value(uint64_t _version) : version(_version) {}
+        ~Value() { state.store(0); }
+    };
+} // namespace
+
+SCENARIO("reloadable config follows changes of the config file")
+{
+    GIVEN("a reloadable config obtained from a config file")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::temp_directory_path() / "cfg_test_reload.yaml";
+        WriteVersion(t_config_path, 1);
+        std::unique_ptr<cfg::ReloadableConfig> config = cfg::GetReloadableConfig_From(t_config_path);
+        REQUIRE(config != nullptr);
+        REQUIRE(config->Get<int>("version").value() == 1);
+
+        WHEN("the config file is replaced")
+        {
+            const cfg::ConfigBase snapshot = config->Snapshot();
+            WriteVersion(t_config_path, 2);
+            THEN("the new config is published")
+            {
+                REQUIRE(WaitFor([&]()
+                                { return config->Get<int>("version").value() == 2; }));
+                REQUIRE(config->Get<int>("road.dims.width").value() == 4);
+                REQUIRE(snapshot.Get<int>("version").value() == 1);
+            }
+        }
+        WHEN("the config file is reloaded explicitly")
+        {
+            const uint64_t generation = config->Generation();
+            THEN("the config is published again")
+            {
+                REQUIRE(config->Reload());
+                REQUIRE(config->Generation() > generation);
+            }
+        }
+        WHEN("the config file cannot be loaded")
+        {
+            std::filesystem::remove(t_config_path);
+            THEN("the previous config remains published")
+            {
+                REQUIRE_FALSE(config->Reload());
+                REQUIRE(config->Get<int>("version").value() == 1);
+            }
+        }
+        config.reset();
+        std::filesystem::remove(t_config_path);
+    }
+}
+
+SCENARIO("reloadable config can be read concurrently while the config file is rewritten")
+{
+    GIVEN("a reloadable config and many reader threads")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::temp_directory_path() / "cfg_test_reload_stress.yaml";
+        WriteVersion(t_config_path, 1);
+        std::unique_ptr<cfg::ReloadableConfig> config = cfg::GetReloadableConfig_From(t_config_path);
+        REQUIRE(config != nullptr);
+        const cfg::Key ROAD_DIMS_WIDTH = config->Snapshot().Compile("road.dims.width");
+
+        constexpr int READERS = 8;
+        constexpr int VERSIONS = 50;
+        std::atomic<bool> done{false};
+        std::atomic<uint64_t> inconsistent{0};
+        std::atomic<uint64_t> reads{0};
+        std::vector<std::thread> readers;
+        for (int idx = 0; idx < READERS; idx++)
+        {
+            readers.emplace_back([&]()
+                                 {
+                while (!done.load())
+                {
+                    // Values read directly must exist in every published version
+                    const boost::optional<int> width = config->Get<int>(ROAD_DIMS_WIDTH);
+                    const boost::optional<int> length = config->Get<int>("road.dims.length");
+                    // Values read from one snapshot must belong to the same version
+                    const cfg::ConfigBase snapshot = config->Snapshot();
+                    const int version = snapshot.Get<int>("version").value_or(-1);
+                    if (!width.has_value() || !length.has_value() ||
+                        snapshot.Get<int>("road.dims.width").value_or(-1) != version * 2 ||
+                        snapshot.Get<int>("road.dims.length").value_or(-1) != version * 3)
+                    {
+                        inconsistent.fetch_add(1);
+                    }
+                    reads.fetch_add(1);
+                } });
+        }
+        WHEN("the config file is rewritten repeatedly")
+        {
+            for (int version = 2; version <= VERSIONS; version++)
+            {
+                WriteVersion(t_config_path, version);
+                if (version % 2 == 0)
+                {
+                    config->Reload();
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+            const bool converged = WaitFor([&]()
+                                           { return config->Get<int>("version").value_or(-1) == VERSIONS; });
+            done.store(true);
+            for (std::thread &reader : readers)
+            {
+                reader.join();
+            }
+            THEN("readers always observe complete and consistent configs")
+            {
+                REQUIRE(converged);
+                REQUIRE(reads.load() > 0);
+                REQUIRE(inconsistent.load() == 0);
+            }
+        }
+        config.reset();
+        std::filesystem::remove(t_config_path);
+    }
+}
+
+SCENARIO("read-copy-update cells reclaim values only after their readers have left")
+{
+    GIVEN("a read-copy-update cell and many reader threads")
+    {
+        cfg::detail::RcuCell<Value> cell(std::make_unique<const Value>(0));
+
+        constexpr int READERS = 8;
+        constexpr uint64_t VERSIONS = 20000;
+        std::atomic<bool> done{false};
+        std::atomic<uint64_t> reclaimed{0};
+        std::atomic<uint64_t> reads{0};
+        std::vector<std::thread> readers;
+        for (int idx = 0; idx < READERS; idx++)
+        {
+            readers.emplace_back([&]()
+                                 {
+                while (!done.load())
+                {
+                    const bool alive = cell.Read([](Value const &value)
+                                                 {
+                        // Widens the window, in which a publisher may reclaim the value being read
+                        std::this_thread::yield();
+                        return value.state.load() == ALIVE; });
+                    if (!alive)
+                    {
+                        reclaimed.fetch_add(1);
+                    }
+                    reads.fetch_add(1);
+                } });
+        }
+        WHEN("new values are published in a loop")
+        {
+            // Publications must overlap with reads, also if the readers are not scheduled right away
+            const bool started = WaitFor([&]()
+                                         { return reads.load() > 0; });
+            for (uint64_t version = 1; version <= VERSIONS; version++)
+            {
+                cell.Publish(std::make_unique<const Value>(version));
+                std::this_thread::yield();
+            }
+            done.store(true);
+            for (std::thread &reader : readers)
+            {
+                reader.join();
+            }
+            THEN("readers never observe a reclaimed value")
+            {
+                REQUIRE(started);
+                REQUIRE(reclaimed.load() == 0);
+                REQUIRE(cell.Read([](Value const &value)
+                                  { return value.version; }) == VERSIONS);
+            }
+        }
+    }
+}
+
+SCENARIO("config differences between versions can be computed")
+{
+    GIVEN("two versions of a config file")
+    {
+        const std::filesystem::path t_dir = std::filesystem::temp_directory_path();
+        const std::filesystem::path t_old_path = t_dir / "cfg_test_diff_old.yaml";
+        const std::filesystem::path t_new_path = t_dir / "cfg_test_diff_new.yaml";
+        const std::filesystem::path t_image_path = t_dir / "cfg_test_diff_new.cfgc";
+        std::ofstream(t_old_path, std::ios::trunc) << "name: road\n"
+                                                   << "road:\n"
+                                                   << "  dims: {width: 12., length: 50.}\n"
+                                                   << "  lanes: [1, 2]\n"
+                                                   << "  color: {hue: 0.2}\n"
+                                                   << "debug: true\n";
+        std::ofstream(t_new_path, std::ios::trunc) << "road:\n"
+                                                   << "  lanes: [1, 2]\n"
+                                                   << "  dims: {length: 50., width: 14., height: 5.}\n"
+                                                   << "  color: red\n"
+                                                   << "name: road\n"
+                                                   << "limits: {speed: 50}\n";
+        REQUIRE(cfg::CompileConfig(t_new_path, t_image_path));
+        cfg::LoadOptions lazy;
+        lazy.lazy = true;
+        const cfg::ConfigBase older = cfg::GetConfig_From(t_old_path).value();
+        WHEN("versions are compared")
+        {
+            const std::vector<cfg::ConfigBase> newer = {cfg::GetConfig_From(t_new_path).value(),
+                                                        cfg::GetConfig_From(t_new_path, lazy).value(),
+                                                        cfg::GetConfig_From(t_image_path).value()};
+            THEN("added, removed and modified keys are reported irrespective of the order of keys")
+            {
+                const std::vector<std::string> e_added = {"limits", "road.dims.height"};
+                const std::vector<std::string> e_removed = {"debug"};
+                const std::vector<std::string> e_modified = {"road.color", "road.dims.width"};
+                for (cfg::ConfigBase const &base : newer)
+                {
+                    const cfg::ConfigDiff diff = older.Diff(base);
+                    REQUIRE(diff.added == e_added);
+                    REQUIRE(diff.removed == e_removed);
+                    REQUIRE(diff.modified == e_modified);
+                    REQUIRE(diff.Touches("road"));
+                    REQUIRE(diff.Touches("road.color.hue"));
+                    REQUIRE(diff.Touches("limits.speed"));
+                    REQUIRE(diff.Touches(""));
+                    REQUIRE_FALSE(diff.Touches("road.lanes"));
+                    REQUIRE_FALSE(diff.Touches("road.dims.length"));
+                    REQUIRE_FALSE(diff.Touches("name"));
+                    REQUIRE_FALSE(diff.Touches("road.dim"));
+                    REQUIRE(base.Diff(base).Empty());
+                }
+            }
+        }
+        WHEN("a version is compared to a copy of itself or to a reload of the same file")
+        {
+            const cfg::ConfigBase copy = older;
+            const cfg::ConfigBase reloaded = cfg::GetConfig_From(t_old_path).value();
+            THEN("there are no differences")
+            {
+                REQUIRE(older.Diff(copy).Empty());
+                REQUIRE(older.Diff(reloaded).Empty());
+                REQUIRE_FALSE(older.Diff(reloaded).Touches(""));
+            }
+        }
+        for (std::filesystem::path const &path : {t_old_path, t_new_path, t_image_path})
+        {
+            std::filesystem::remove(path);
+        }
+    }
+}
+
+SCENARIO("reloadable config notifies subscribers of changed keys")
+{
+    GIVEN("a reloadable config with subscribers to different keys")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::temp_directory_path() / "cfg_test_subscribe.yaml";
+        WriteVersion(t_config_path, 1);
+        std::unique_ptr<cfg::ReloadableConfig> config = cfg::GetReloadableConfig_From(t_config_path);
+        REQUIRE(config != nullptr);
+        std::atomic<int> any{0};
+        std::atomic<int> version{0};
+        std::atomic<int> dims{0};
+        std::atomic<int> missing{0};
+        std::atomic<int> width{0};
+        config->Subscribe("", [&](cfg::ConfigDiff const &, cfg::ConfigBase const &)
+                          { any.fetch_add(1); });
+        config->Subscribe("version", [&](cfg::ConfigDiff const &, cfg::ConfigBase const &current)
+                          { version.store(current.Get<int>("version").value_or(-1)); });
+        config->Subscribe("road.dims", [&](cfg::ConfigDiff const &, cfg::ConfigBase const &)
+                          { dims.fetch_add(1); });
+        config->Subscribe("road.color", [&](cfg::ConfigDiff const &, cfg::ConfigBase const &)
+                          { missing.fetch_add(1); });
+        const uint64_t width_id = config->Subscribe("road.dims.width", [&](cfg::ConfigDiff const &,
+                                                                           cfg::ConfigBase const &)
+                                                    { width.fetch_add(1); });
+
+        WHEN("the config file is reloaded without changes")
+        {
+            REQUIRE(config->Reload());
+            THEN("no subscriber is notified")
+            {
+                REQUIRE(any.load() == 0);
+                REQUIRE(dims.load() == 0);
+            }
+        }
+        WHEN("values of the config file change")
+        {
+            config->Unsubscribe(width_id);
+            WriteVersion(t_config_path, 2);
+            REQUIRE(config->Reload());
+            THEN("only subscribers of changed keys are notified")
+            {
+                REQUIRE(any.load() >= 1);
+                REQUIRE(version.load() == 2);
+                REQUIRE(dims.load() >= 1);
+                REQUIRE(missing.load() == 0);
+                REQUIRE(width.load() == 0);
+            }
+        }
+        config.reset();
+        std::filesystem::remove(t_config_path);
+    }
+}
+
+SCENARIO("configs can be published to shared memory and attached by other processes")
+{
+    GIVEN("a config file published into shared memory")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::temp_directory_path() / "cfg_test_published.yaml";
+        const std::string t_name = "cfg_test_published_" + std::to_string(::getpid());
+        WriteVersion(t_config_path, 1);
+        REQUIRE(cfg::PublishConfig(t_config_path, t_name));
+        WHEN("the published config is attached")
+        {
+            std::unique_ptr<cfg::PublishedConfig> published = cfg::GetPublishedConfig_From(t_name);
+            THEN("config values are read from the published image")
+            {
+                REQUIRE(published != nullptr);
+                REQUIRE(published->Generation() == 1);
+                REQUIRE(published->Get<int>("version").value() == 1);
+                REQUIRE(published->Get<int>(published->Snapshot().Compile("road.dims.width")).value() == 2);
+                REQUIRE_FALSE(published->Get<int>("road.dims.height").has_value());
+                REQUIRE_FALSE(published->Refresh());
+            }
+        }
+        WHEN("a new version is published while the config is attached")
+        {
+            std::unique_ptr<cfg::PublishedConfig> published = cfg::GetPublishedConfig_From(t_name);
+            const cfg::ConfigBase previous = published->Snapshot();
+            WriteVersion(t_config_path, 2);
+            REQUIRE(cfg::PublishConfig(t_config_path, t_name));
+            THEN("the new version is attached on refresh, while the previous one remains readable")
+            {
+                REQUIRE(published->PublishedGeneration() == 2);
+                REQUIRE(published->Get<int>("version").value() == 1);
+                REQUIRE(published->Refresh());
+                REQUIRE(published->Generation() == 2);
+                REQUIRE(published->Get<int>("version").value() == 2);
+                REQUIRE(published->Get<int>("road.dims.length").value() == 6);
+                REQUIRE(previous.Get<int>("version").value() == 1);
+                REQUIRE_FALSE(published->Refresh());
+            }
+        }
+#ifdef __unix__
+        WHEN("the published config is attached by a forked process")
+        {
+            const pid_t pid = ::fork();
+            if (pid == 0)
+            {
+                std::unique_ptr<cfg::PublishedConfig> published = cfg::GetPublishedConfig_From(t_name);
+                ::_exit(published && published->Get<int>("road.dims.width") == 2 ? 0 : 1);
+            }
+            int status = -1;
+            ::waitpid(pid, &status, 0);
+            THEN("config values are read from the same image")
+            {
+                REQUIRE(WIFEXITED(status));
+                REQUIRE(WEXITSTATUS(status) == 0);
+            }
+        }
+#endif
+        WHEN("the config is unpublished")
+        {
+            std::unique_ptr<cfg::PublishedConfig> published = cfg::GetPublishedConfig_From(t_name);
+            REQUIRE(cfg::UnpublishConfig(t_name));
+            THEN("it can no longer be attached, while attached configs remain readable")
+            {
+                REQUIRE(cfg::GetPublishedConfig_From(t_name) == nullptr);
+                REQUIRE_FALSE(published->Refresh());
+                REQUIRE(published->Get<int>("version").value() == 1);
+                REQUIRE_FALSE(cfg::UnpublishConfig(t_name));
+            }
+        }
+        WHEN("a name, which is not published or invalid, is attached")
+        {
+            THEN("published config cannot be obtained")
+            {
+                REQUIRE(cfg::GetPublishedConfig_From(t_name + "_missing") == nullptr);
+                REQUIRE(cfg::GetPublishedConfig_From("invalid/name") == nullptr);
+                REQUIRE_FALSE(cfg::PublishConfig(t_config_path, ""));
+            }
+        }
+        WHEN("a name, which extends the published name by a generation suffix, is published as well")
+        {
+            // Images are named after their config and generation, hence the name would collide with an image
+            const bool suffixed = cfg::PublishConfig(t_config_path, t_name + ".1");
+            REQUIRE(cfg::PublishConfig(t_config_path, t_name));
+            THEN("the suffixed name is rejected and the published config remains attachable")
+            {
+                REQUIRE_FALSE(suffixed);
+                REQUIRE(cfg::GetPublishedConfig_From(t_name + ".1") == nullptr);
+                REQUIRE(cfg::GetPublishedConfig_From(t_name) != nullptr);
+            }
+        }
+        cfg::UnpublishConfig(t_name);
+        std::filesystem::remove(t_config_path);
+    }
+}
+
+SCENARIO("config changes can be committed to the config file")
+{
+    GIVEN("a writable config of a commented config file")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::temp_directory_path() / "cfg_test_writable.yaml";
+        std::ofstream(t_config_path, std::ios::trunc) << "# tuned parameters\n"
+                                                       << "gain: 0.5 # proportional\n"
+                                                       << "mode: 'auto'\n"
+                                                       << "road:\n"
+                                                       << "  point: [2.3, 5.2, 5.9]\n"
+                                                       << "  limits: {lower: 1, upper: 2}\n"
+                                                       << "  lanes:\n"
+                                                       << "    - 1\n"
+                                                       << "    - 2\n"
+                                                       << "threshold: ~\n";
+        std::unique_ptr<cfg::WritableConfig> writable = cfg::GetWritableConfig_From(t_config_path);
+        REQUIRE(writable);
+        WHEN("values and new keys are changed in a batch")
+        {
+            writable->Set("gain", 0.75);
+            writable->Set<std::string>("mode", "manual");
+            writable->Set("road.point", cfg::Vec3D{1.5, 2.5, 3.5});
+            writable->Set("road.limits.upper", 4);
+            writable->Set("road.width", 12);
+            writable->Set("threshold", 3);
+            writable->Set("pid.integral.gain", 0.25);
+            THEN("changes are visible only once committed, after which the text is patched in place")
+            {
+                REQUIRE(writable->Pending() == 7);
+                REQUIRE(writable->Get<double>("gain").value() == 0.5);
+                REQUIRE(writable->Commit());
+                REQUIRE(writable->Pending() == 0);
+                REQUIRE(writable->Generation() == 1);
+                REQUIRE(writable->Get<double>("gain").value() == 0.75);
+                REQUIRE(writable->Get<std::string>("mode").value() == "manual");
+                REQUIRE(writable->Get<cfg::Vec3D>("road.point").value() == cfg::Vec3D{1.5, 2.5, 3.5});
+                REQUIRE(writable->Get<int>("road.limits.lower").value() == 1);
+                REQUIRE(writable->Get<int>("road.limits.upper").value() == 4);
+                REQUIRE(writable->Get<int>("road.width").value() == 12);
+                REQUIRE(writable->Get<int>("threshold").value() == 3);
+                REQUIRE(writable->Get<double>("pid.integral.gain").value() == 0.25);
+                REQUIRE(writable->Get<std::vector<int>>("road.lanes").value() == std::vector<int>{1, 2});
+                const std::string text = ReadText(t_config_path);
+                REQUIRE(text.find("# tuned parameters\ngain: 0.75 # proportional\n") == 0);
+                REQUIRE(text.find("  lanes:\n    - 1\n    - 2\n") != std::string::npos);
+                REQUIRE(cfg::GetConfig_From(t_config_path)->Get<int>("road.width").value() == 12);
+            }
+        }
+        WHEN("a thousand changes are committed")
+        {
+            const cfg::ConfigBase previous = writable->Snapshot();
+            for (int idx = 1; idx <= 1000; idx++)
+            {
+                writable->Set("gain", idx / 1000.);
+                writable->Set("road.limits.lower", idx);
+            }
+            THEN("the latest changes are persisted with a single commit")
+            {
+                REQUIRE(writable->Commit());
+                REQUIRE(writable->Generation() == 1);
+                REQUIRE(writable->Get<double>("gain").value() == 1.);
+                REQUIRE(writable->Get<int>("road.limits.lower").value() == 1000);
+                REQUIRE(previous.Get<double>("gain").value() == 0.5);
+            }
+        }
+        WHEN("a value, which cannot be patched in place, is changed")
+        {
+            writable->Set("road.lanes", std::vector<int>{3, 4, 5});
+            THEN("the whole config is emitted")
+            {
+                REQUIRE(writable->Commit());
+                REQUIRE(writable->Get<std::vector<int>>("road.lanes").value() == std::vector<int>{3, 4, 5});
+                REQUIRE(writable->Get<double>("gain").value() == 0.5);
+                REQUIRE(writable->Get<cfg::Vec3D>("road.point").value() == cfg::Vec3D{2.3, 5.2, 5.9});
+            }
+        }
+        WHEN("a value is changed underneath a value, which is not a map")
+        {
+            const std::string text = ReadText(t_config_path);
+            writable->Set("gain.inner", 1);
+            THEN("the commit fails, leaving the file and the pending changes as they are")
+            {
+                REQUIRE_FALSE(writable->Commit());
+                REQUIRE(ReadText(t_config_path) == text);
+                REQUIRE(writable->Pending() == 1);
+                writable->Discard();
+                REQUIRE(writable->Pending() == 0);
+                REQUIRE(writable->Commit());
+                REQUIRE(writable->Generation() == 0);
+            }
+        }
+        WHEN("two writable configs of the same file commit concurrently")
+        {
+            std::filesystem::permissions(t_config_path, std::filesystem::perms::owner_read |
+                                                            std::filesystem::perms::owner_write |
+                                                            std::filesystem::perms::group_read);
+            std::unique_ptr<cfg::WritableConfig> other = cfg::GetWritableConfig_From(t_config_path);
+            REQUIRE(other);
+            std::atomic<int> failures{0};
+            std::vector<std::thread> writers;
+            for (cfg::WritableConfig *writer : {writable.get(), other.get()})
+            {
+                writers.emplace_back([writer, &failures]()
+                                     {
+                    for (int idx = 1; idx <= 20; idx++)
+                    {
+                        writer->Set("gain", idx / 20.);
+                        if (!writer->Commit())
+                        {
+                            failures.fetch_add(1);
+                        }
+                    } });
+            }
+            for (std::thread &writer : writers)
+            {
+                writer.join();
+            }
+            THEN("every commit replaces the whole file, which keeps its permissions, without leaving temporary files")
+            {
+                REQUIRE(failures.load() == 0);
+                REQUIRE(cfg::GetConfig_From(t_config_path)->Get<double>("gain").value() == 1.);
+                REQUIRE(std::filesystem::status(t_config_path).permissions() ==
+                        (std::filesystem::perms::owner_read | std::filesystem::perms::owner_write |
+                         std::filesystem::perms::group_read));
+                size_t leftovers = 0;
+                for (auto const &entry : std::filesystem::directory_iterator(t_config_path.parent_path()))
+                {
+                    const std::string name = entry.path().filename().string();
+                    leftovers += name.rfind(t_config_path.filename().string() + ".", 0) == 0 ? 1 : 0;
+                }
+                REQUIRE(leftovers == 0);
+            }
+        }
+        std::filesystem::remove(t_config_path);
+    }
+}
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "cfg.hpp"
+#include "stats.hpp"
+
+SCENARIO("config accesses are recorded by the instrumentation")
+{
+    GIVEN("config base apis obtained from valid file path, parsed, lazily parsed and compiled into an image")
+    {
+        const std::filesystem::path t_config_path = std::filesystem::absolute("../../tests/test_config_basic.yaml");
+        const std::filesystem::path t_image_path = std::filesystem::temp_directory_path() / "cfg_test_stats.cfgc";
+        const std::filesystem::path t_other_path = std::filesystem::temp_directory_path() / "cfg_test_stats.yaml";
+        REQUIRE(cfg::CompileConfig(t_config_path, t_image_path));
+        std::filesystem::copy_file(t_config_path, t_other_path, std::filesystem::copy_options::overwrite_existing);
+        // Another config with the same keys, whose reads must not be counted for the configs under test
+        const cfg::ConfigBase other = cfg::GetConfig_From(t_other_path).value();
+        cfg::LoadOptions lazy;
+        lazy.lazy = true;
+        const std::vector<cfg::ConfigBase> bases = {cfg::GetConfig_From(t_config_path).value(),
+                                                    cfg::GetConfig_From(t_config_path, lazy).value(),
+                                                    cfg::GetConfig_From(t_image_path).value()};
+        WHEN("keys are looked up from several threads")
+        {
+            THEN("lookups are counted per key and unread keys are reported")
+            {
+                for (size_t pos = 0; pos < bases.size(); pos++)
+                {
+                    cfg::ConfigBase const &base = bases[pos];
+                    cfg::ResetAccessStats();
+                    std::vector<std::thread> threads;
+                    for (size_t idx = 0; idx < 4; idx++)
+                    {
+                        threads.emplace_back([&base]()
+                                             {
+                                                 for (size_t num = 0; num < 10; num++)
+                                                 {
+                                                     base.Get<double>("road.dims.width");
+                                                 }
+                                                 base.Get<double>(base.Compile("road.dims.invalid"));
+                                                 base.Cached<cfg::Vec3D>("attributes.point");
+                                                 base.Cached<double>("attributes.name");
+                                                 base.TryGet<double>("attributes.name"); });
+                    }
+                    for (std::thread &thread : threads)
+                    {
+                        thread.join();
+                    }
+                    cfg::Batch batch;
+                    batch.Add<double>("pi");
+                    batch.Add<double>("road.color");
+                    base.Get(batch);
+                    other.Get<double>("road.dims.width");
+                    other.Get<bool>("attributes.debug");
+                    other.Cached<std::string>("attributes.name");
+                    const cfg::AccessReport report = base.AccessStats(2);
+#ifdef CFG_WITH_INSTRUMENTATION
+                    REQUIRE(report.enabled);
+                    REQUIRE(report.total.Reads() == 4 * 14 + 2);
+                    REQUIRE(report.total.hits == 4 * 11 + 1);
+                    REQUIRE(report.total.misses == 4);
+                    // Memoized lookups, which cannot be decoded, are failures rather than misses
+                    REQUIRE(report.total.failures == 4 * 2 + 1);
+                    REQUIRE(report.hot.size() == 2);
+                    REQUIRE(report.hot[0].key == "road.dims.width");
+                    REQUIRE(report.hot[0].hits == 40);
+                    REQUIRE(report.hot[0].Percentile(0.5) > 0);
+                    // Sections of a lazily parsed config, which have never been looked up, are reported as a whole
+                    const std::vector<std::string> e_unread = {"attributes.debug", "attributes.rgb",
+                                                               "attributes.names", "road.dims.length",
+                                                               "road.dims.height",
+                                                               pos == 1 ? "error" : "error.malformed"};
+                    REQUIRE(report.unread == e_unread);
+                    REQUIRE(report.ToJson().find("\"key\": \"road.dims.width\"") != std::string::npos);
+                    REQUIRE(report.ToText().find("road.dims.width: 40 reads") != std::string::npos);
+#else
+                    REQUIRE_FALSE(report.enabled);
+                    REQUIRE(report.total.Reads() == 0);
+                    REQUIRE(report.hot.empty());
+                    REQUIRE(report.unread.empty());
+#endif
+                }
+            }
+        }
+        std::filesystem::remove(t_image_path);
+        std::filesystem::remove(t_other_path);
+    }
+}
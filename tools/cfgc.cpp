@@ -0,0 +1,15 @@
+#include <iostream>
+
+#include "image.hpp"
+
+/// Compiles a YAML config file into a compiled config image, which cfg::GetConfig_From maps into memory.
+/// Usage: cfgc <input.yaml> <output>
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input.yaml> <output>\n";
+        return 2;
+    }
+    return cfg::CompileConfig(argv[1], argv[2]) ? 0 : 1;
+}